@@ -72,17 +72,70 @@ void DestroyModule(void* pModule)
 // module constructors/destructors
 //-------------------------------------------------------------------------
 
+// makes those of the first count sources of engine that do not exist yet,
+// channel c on substream firstSub + c of stream, so that no two channels or
+// instances can overlap
+static void growSources (RandomSource** channelSources, int count, int engine,
+	uint64_t stream, int firstSub)
+{
+	for (int c = 0; c < count; c++){
+		if (!channelSources[c]){
+			channelSources[c] = new RandomSource();
+			channelSources[c]->setEngine(engine);
+			channelSources[c]->seedStream(stream, firstSub + c);
+		}
+	}
+}
+
+// the source the slots' distributions are built on
+static RandomSource& firstSource (RandomSource** channelSources, uint64_t stream)
+{
+	growSources(channelSources, 1, ENGINE_MT19937, stream, 0);
+	return *channelSources[0];
+}
+
 // constructor
 TemplateModule::TemplateModule()
+	: instanceStream(RandomSource::newStream()), sources(), workerSources(),
+	  audio(firstSource(sources[ENGINE_MT19937], instanceStream)), prefill(0), triggers(0),
+	  workerRunning(false), workerPending(false), workerWaiting(false),
+	  underruns(0), underrunsShown(-1), prefillFrames(0), audioEpoch(0),
+	  positionsSeq(0), positionsRevision(-1), audioPositions(),
+	  seeksTaken(0), lfo(MAX_CHANNELS), lfoRate(eButton), sampleRate(44100.0)
 {
-	rate = 0;
-	mt.seed(static_cast<long int>(time(NULL)));
+	edit.rate = eButton;
+	edit.engine = ENGINE_MT19937;
+	edit.type = UNIFORM;
+	edit.generation = eInline;
+	edit.channels = 1;
+	edit.epoch = 0;
+	edit.revision = 0;
+	edit.seeks = 0;
+	edit.min = 0.0001f;
+	edit.max = 1.0f;
+	edit.paramA = 0.5f;
+	edit.paramB = 0.5f;
+	edit.frequency = 1.0f;
+	edit.position = 0;
+	edit.ring = 0;
+	initSlots(audio);
 }
 
 // destructor
 TemplateModule::~TemplateModule()
 {
-	// 
+	stopWorker();
+	delete prefill;
+	for (int e = 0; e < NUM_ENGINES; e++){
+		for (int c = 0; c < MAX_CHANNELS; c++){
+			delete sources[e][c];
+			delete workerSources[e][c];
+		}
+	}
+	delete edit.ring;
+	for (size_t i = 0; i < retiredRings.size(); i++){
+		delete retiredRings[i].ring;
+	}
 }
 
 
@@ -104,7 +157,19 @@ void TemplateModule::onGetModuleInfo (MasterInfo* pMasterInfo, ModuleInfo* pModu
 // query system and init
 int  TemplateModule::onGetNumberOfParams( int QIdx) {return 0;}
 void TemplateModule::onAfterQuery (MasterInfo* pMasterInfo, ModuleInfo* pModuleInfo, int QIdx) {}
-void TemplateModule::onInitModule (MasterInfo* pMasterInfo, ModuleInfo* pModuleInfo) {}
+void TemplateModule::onInitModule (MasterInfo* pMasterInfo, ModuleInfo* pModuleInfo)
+{
+	sampleRate = sdkGetSampleRate();
+	if (prefillFrames == 0){
+		// the host's block size until onBlocSizeChange tells otherwise; the
+		// worker does not run yet
+		prefillFrames = sdkGetBlocSize();
+		scratch.resize(prefillFrames);
+		workerScratch.resize(prefillFrames);
+	}
+	readParams(dirtyAll);
+	publishParams(dirtyAll);
+}
 
 //-----------------------------------------------------------------------------
 // parameters and process
@@ -119,7 +184,19 @@ void TemplateModule::onGetParamInfo (int ParamIndex, TParamInfo* pParamInfo)
 		pParamInfo->Caption				= "Rate";
 		pParamInfo->IsInput				= TRUE;
 		pParamInfo->IsOutput			= FALSE;
-		pParamInfo->ListBoxStrings		= "\"Button\",\"Control\",\"Audio\"";
+		pParamInfo->ListBoxStrings		= "\"Button\",\"Control\",\"Audio\",\"Step\",\"Linear\",\"Cosine\",\"Cubic\"";
+		pParamInfo->DefaultValue		= 0; 
+		pParamInfo->ReadOnly			= FALSE;
+		pParamInfo->IsStoredInPreset	= TRUE;
+		pParamInfo->CallBackType		= ctImmediate;
+		break;
+
+	case eEngine:
+		pParamInfo->ParamType			= ptListBox;
+		pParamInfo->Caption				= "Engine";
+		pParamInfo->IsInput				= TRUE;
+		pParamInfo->IsOutput			= FALSE;
+		pParamInfo->ListBoxStrings		= "\"MT19937\",\"SFMT\",\"xoshiro128+\",\"xoshiro256**\",\"PCG32\",\"SplitMix64\",\"Philox\"";
 		pParamInfo->DefaultValue		= 0; 
 		pParamInfo->ReadOnly			= FALSE;
 		pParamInfo->IsStoredInPreset	= TRUE;
@@ -146,7 +223,7 @@ void TemplateModule::onGetParamInfo (int ParamIndex, TParamInfo* pParamInfo)
 		pParamInfo->Caption				= "Type";
 		pParamInfo->IsInput				= TRUE;
 		pParamInfo->IsOutput			= FALSE;
-		pParamInfo->ListBoxStrings		= "\"Uniform\",\"Linear\",\"Triangular\",\"Exponential\",\"Bilateral\",\"Gausian\",\"Cauchy\",\"Weibull\" ";
+		pParamInfo->ListBoxStrings		= "\"Uniform\",\"Linear\",\"Triangular\",\"Exponential\",\"Bilateral\",\"Gausian\",\"Cauchy\",\"Weibull\",\"Gaussian (legacy)\",\"Beta\",\"Gamma\",\"Poisson\",\"Binomial\",\"Geometric\",\"Discrete\",\"Empirical\" ";
 		pParamInfo->DefaultValue		= 0; 
 		pParamInfo->ReadOnly			= FALSE;
 		pParamInfo->IsStoredInPreset	= TRUE;
@@ -213,6 +290,101 @@ void TemplateModule::onGetParamInfo (int ParamIndex, TParamInfo* pParamInfo)
 		pParamInfo->Format			    = "%.3f";
 		break;
 
+	case eWeights:
+		pParamInfo->ParamType		= ptArray;
+		pParamInfo->Caption			= "weights";
+		pParamInfo->IsInput			= TRUE;
+		pParamInfo->IsOutput		= FALSE;
+		pParamInfo->ReadOnly		= FALSE;
+		pParamInfo->CallBackType	= ctImmediate;
+		break;
+
+	case eGeneration:
+		pParamInfo->ParamType			= ptListBox;
+		pParamInfo->Caption				= "Generation";
+		pParamInfo->IsInput				= TRUE;
+		pParamInfo->IsOutput			= FALSE;
+		pParamInfo->ListBoxStrings		= "\"Inline\",\"Background\"";
+		pParamInfo->DefaultValue		= 0; 
+		pParamInfo->ReadOnly			= FALSE;
+		pParamInfo->IsStoredInPreset	= TRUE;
+		pParamInfo->CallBackType		= ctImmediate;
+		break;
+
+	case eUnderruns:
+		pParamInfo->ParamType			= ptDataField;
+		pParamInfo->Caption				= "underruns";
+		pParamInfo->IsInput				= FALSE;
+		pParamInfo->IsOutput			= TRUE;
+		pParamInfo->DefaultValue		= 0; 
+		pParamInfo->MinValue            = 0;
+		pParamInfo->MaxValue            = std::numeric_limits<float>::max();
+		pParamInfo->ReadOnly			= TRUE;
+		pParamInfo->IsStoredInPreset	= FALSE;
+		pParamInfo->CallBackType		= ctImmediate;
+		pParamInfo->Format			    = "%.0f";
+		break;
+
+	case eFrequency:
+		pParamInfo->ParamType			= ptDataFader;
+		pParamInfo->Caption				= "Frequency";
+		pParamInfo->IsInput				= TRUE;
+		pParamInfo->IsOutput			= FALSE;
+		pParamInfo->DefaultValue		= 1.0f; 
+		pParamInfo->MinValue            = 0.01f;
+		pParamInfo->MaxValue            = 20000.0f;
+		pParamInfo->ReadOnly			= FALSE;
+		pParamInfo->IsStoredInPreset	= TRUE;
+		pParamInfo->CallBackType		= ctImmediate;
+		pParamInfo->Symbol			    = "Hz";
+		pParamInfo->Format			    = "%.2f";
+		break;
+
+	case eChannels:
+		pParamInfo->ParamType			= ptDataFader;
+		pParamInfo->Caption				= "Channels";
+		pParamInfo->IsInput				= TRUE;
+		pParamInfo->IsOutput			= FALSE;
+		pParamInfo->DefaultValue		= 1; 
+		pParamInfo->MinValue            = 1;
+		pParamInfo->MaxValue            = MAX_CHANNELS;
+		pParamInfo->ReadOnly			= FALSE;
+		pParamInfo->IsStoredInPreset	= TRUE;
+		pParamInfo->CallBackType		= ctImmediate;
+		pParamInfo->Symbol			    = " ";
+		pParamInfo->Format			    = "%.0f";
+		break;
+
+	case ePosition:
+		pParamInfo->ParamType			= ptDataField;
+		pParamInfo->Caption				= "Position";
+		pParamInfo->IsInput				= TRUE;
+		pParamInfo->IsOutput			= FALSE;
+		pParamInfo->DefaultValue		= 0; 
+		pParamInfo->MinValue            = 0;
+		pParamInfo->MaxValue            = std::numeric_limits<float>::max();
+		pParamInfo->ReadOnly			= FALSE;
+		pParamInfo->IsStoredInPreset	= FALSE;
+		pParamInfo->CallBackType		= ctImmediate;
+		pParamInfo->Symbol			    = "smp";
+		pParamInfo->Format			    = "%.0f";
+		break;
+
+	case eSeconds:
+		pParamInfo->ParamType			= ptDataField;
+		pParamInfo->Caption				= "Seconds";
+		pParamInfo->IsInput				= TRUE;
+		pParamInfo->IsOutput			= FALSE;
+		pParamInfo->DefaultValue		= 0; 
+		pParamInfo->MinValue            = 0;
+		pParamInfo->MaxValue            = std::numeric_limits<float>::max();
+		pParamInfo->ReadOnly			= FALSE;
+		pParamInfo->IsStoredInPreset	= FALSE;
+		pParamInfo->CallBackType		= ctImmediate;
+		pParamInfo->Symbol			    = "s";
+		pParamInfo->Format			    = "%.3f";
+		break;
+
 		// default case
 	default:
 		break;
@@ -225,146 +397,630 @@ void TemplateModule::onSetEventAddress (int ParamIndex, UsineEventPtr pEvent)
 }
 void TemplateModule::onCallBack (UsineMessage *Message) {
 
+	// the callbacks never touch what onProcess uses: they read the changed
+	// input, configure the back slot and publish it
+	int changed = 0;
 	switch (Message->wParam) 
 	{
 	case eRate:
-		rate = (int)sdkGetEvtData(params[eRate]);
+	case eFrequency:
+		changed = dirtyRate;
+		break;
+	case eEngine:
+		changed = dirtyEngine;
 		break;
 	case eTrigger:
-		if(Message->lParam == MSG_CHANGE && sdkGetEvtData(params[eRate]) == eButton){
-			float data;
-		    if(sdkGetEvtData(params[eMax]) > sdkGetEvtData(params[eMin])){
-		        data = distribution.value(sdkGetEvtData(params[eMin]), sdkGetEvtData(params[eMax]), 128);
-		        if(data == 0.0f){
-			        data = sdkGetEvtData(params[eMin]);
-		        }
-		    }else{
-		        data = 0.f;
-		    }
-			sdkSetEvtSize(params[eOut], 1);
-			sdkSetEvtData(params[eOut], data);
+		// answered by onProcess at the next block
+		if(Message->lParam == MSG_CHANGE){
+			triggers.fetch_add(1, std::memory_order_relaxed);
 		} 
 		break;
 	case eOut:
 		//params[eOut] = pEvent;
 		break;
-	case eParamA:
-		distribution.doBilateral(sdkGetEvtData(params[eParamA]));
-		distribution.doExponential(sdkGetEvtData(params[eParamA]) * 5.f);
-		distribution.doCauchy(sdkGetEvtData(params[eParamA]), sdkGetEvtData(params[eParamB]));
-		distribution.doGaussian(sdkGetEvtData(params[eParamA]), sdkGetEvtData(params[eParamB]));
-		distribution.doWeibull((sdkGetEvtData(params[eParamA]) * 0.99f) + 0.01, sdkGetEvtData(params[eParamB]));
-		switch((int)sdkGetEvtData(params[eType])){
-		    case 0: distribution.setType(UNIFORM);break;
-			case 1: distribution.setType(LINEAR);break;
-			case 2: distribution.setType(TRIANGULAR);break;
-			case 3: distribution.setType(EXPONENTIAL);break;
-			case 4: distribution.setType(BILATERAL);break;
-			case 5: distribution.setType(GAUSSIAN);break;
-			case 6: distribution.setType(CAUCHY);break;
-			case 7: distribution.setType(WEIBULL);break;
-			default: distribution.setType(UNIFORM);break;
-		}
+	case eType:
+		changed = dirtyType;
 		break;
+	case eMin:
+	case eMax:
+		changed = dirtyRange;
+		break;
+	case eParamA:
 	case eParamB:
-		distribution.doCauchy(sdkGetEvtData(params[eParamA]), sdkGetEvtData(params[eParamB]));
-		distribution.doGaussian(sdkGetEvtData(params[eParamA]), sdkGetEvtData(params[eParamB]));
-		distribution.doWeibull((sdkGetEvtData(params[eParamA]) * 0.99f) + 0.01, sdkGetEvtData(params[eParamB]));
-		switch((int)sdkGetEvtData(params[eType])){
-		    case 0: distribution.setType(UNIFORM);break;
-			case 1: distribution.setType(LINEAR);break;
-			case 2: distribution.setType(TRIANGULAR);break;
-			case 3: distribution.setType(EXPONENTIAL);break;
-			case 4: distribution.setType(BILATERAL);break;
-			case 5: distribution.setType(GAUSSIAN);break;
-			case 6: distribution.setType(CAUCHY);break;
-			case 7: distribution.setType(WEIBULL);break;
-			default: distribution.setType(UNIFORM);break;
-		}
+		changed = dirtyShape;
 		break;
-	case eType:
-		switch((int)sdkGetEvtData(params[eType])){
-		    case 0: distribution.setType(UNIFORM);break;
-			case 1: distribution.setType(LINEAR);break;
-			case 2: distribution.setType(TRIANGULAR);break;
-			case 3: distribution.setType(EXPONENTIAL);break;
-			case 4: distribution.setType(BILATERAL);break;
-			case 5: distribution.setType(GAUSSIAN);break;
-			case 6: distribution.setType(CAUCHY);break;
-			case 7: distribution.setType(WEIBULL);break;
-			default: distribution.setType(UNIFORM);break;
-		}
+	case eWeights:
+		changed = dirtyWeights;
 		break;
-	case eMin:
-		if(sdkGetEvtData(params[eMax]) > sdkGetEvtData(params[eMin])){
-			float temp = sdkGetEvtData(params[eMin]) + ((sdkGetEvtData(params[eMax]) - sdkGetEvtData(params[eMin])) * 0.5f);
-			distribution.doTriangular(sdkGetEvtData(params[eMin]), temp, sdkGetEvtData(params[eMax]));
-			distribution.doUniform(sdkGetEvtData(params[eMin]), sdkGetEvtData(params[eMax]));
-		}
-		switch((int)sdkGetEvtData(params[eType])){
-		    case 0: distribution.setType(UNIFORM);break;
-			case 1: distribution.setType(LINEAR);break;
-			case 2: distribution.setType(TRIANGULAR);break;
-			case 3: distribution.setType(EXPONENTIAL);break;
-			case 4: distribution.setType(BILATERAL);break;
-			case 5: distribution.setType(GAUSSIAN);break;
-			case 6: distribution.setType(CAUCHY);break;
-			case 7: distribution.setType(WEIBULL);break;
-			default: distribution.setType(UNIFORM);break;
-		}
+	case eGeneration:
+		changed = dirtyGeneration;
 		break;
-	case eMax:
-		if(sdkGetEvtData(params[eMax]) > sdkGetEvtData(params[eMin])){
-			float temp = sdkGetEvtData(params[eMin]) + ((sdkGetEvtData(params[eMax]) - sdkGetEvtData(params[eMin])) * 0.5f);
-			distribution.doTriangular(sdkGetEvtData(params[eMin]), temp, sdkGetEvtData(params[eMax]));
-			distribution.doUniform(sdkGetEvtData(params[eMin]), sdkGetEvtData(params[eMax]));
-		}
-		switch((int)sdkGetEvtData(params[eType])){
-		    case 0: distribution.setType(UNIFORM);break;
-			case 1: distribution.setType(LINEAR);break;
-			case 2: distribution.setType(TRIANGULAR);break;
-			case 3: distribution.setType(EXPONENTIAL);break;
-			case 4: distribution.setType(BILATERAL);break;
-			case 5: distribution.setType(GAUSSIAN);break;
-			case 6: distribution.setType(CAUCHY);break;
-			case 7: distribution.setType(WEIBULL);break;
-			default: distribution.setType(UNIFORM);break;
-		}
+	case eChannels:
+		changed = dirtyChannels;
+		break;
+	case ePosition:
+	case eSeconds:
+		changed = dirtyPosition;
 		break;
 
 		// default case
 	default:
 		break;
 	}
+	if (changed){
+		readParams(changed);
+		publishParams(changed);
+	}
 }
+// false for the counts and indices, which ignore Min and Max
+static bool usesRange (int type)
+{
+	return type != POISSON && type != BINOMIAL && type != GEOMETRIC && type != DISCRETE;
+}
+
 void TemplateModule::onProcess () {
 
-	if(sdkGetEvtData(params[eRate]) == eControl){
-		float data;
-		if(sdkGetEvtData(params[eMax]) > sdkGetEvtData(params[eMin])){
-		    data = distribution.value(sdkGetEvtData(params[eMin]), sdkGetEvtData(params[eMax]), 128);
-		    if(data == 0.0f){
-			    data = sdkGetEvtData(params[eMin]);
-		    }
+	// pick up the newest configuration, if any, at the block boundary, and
+	// the sources of its engine
+	audio.slots.update();
+	SamplerSlot& slot = audio.slots.front();
+	const ParamSnapshot& snapshot = slot.snapshot;
+	const int channels = snapshot.channels;
+	RandomSource** channelSources = sources[snapshot.engine];
+	audioEpoch.store(snapshot.epoch, std::memory_order_release);
+
+	// a new Position, for the engines which can seek: every channel in use
+	// continues from that number of its stream
+	if (snapshot.seeks != seeksTaken){
+		seeksTaken = snapshot.seeks;
+		if (channelSources[0]->canSeek()){
+			for (int c = 0; c < channels; c++){
+				channelSources[c]->seek(snapshot.position);
+			}
+			slot.distribution.dropBits();
+			lfo.restart();
+		}
+	}
+
+	// one value per channel, or one block interleaved by frame
+	if ((triggers.exchange(0, std::memory_order_relaxed) > 0 && snapshot.rate == eButton)
+			|| snapshot.rate == eControl){
+	    sdkSetEvtSize(params[eOut], channels);
+		TPrecision* out = sdkGetEvtDataAddr(params[eOut]);
+		for (int c = 0; c < channels; c++){
+			out[c] = nextValue(slot, *channelSources[c]);
+		}
+	}else if (snapshot.rate == eAudio){
+		// generated straight into the event's buffer (TPrecision is float)
+		int sampleFrames = sdkGetBlocSize();
+		sdkSetEvtSize(params[eOut], sampleFrames * channels);
+		TPrecision* out = sdkGetEvtDataAddr(params[eOut]);
+		if(snapshot.max <= snapshot.min){
+			std::fill(out, out + sampleFrames * channels, 0.f);
+		}else if(snapshot.generation != eBackground){
+			fillChannels(slot, channelSources, scratch, out, sampleFrames);
 		}else{
-		    data = 0.f;
+			bool released = false;
+			if (!takePrefilled(out, sampleFrames, snapshot, channelSources, released))
+				fillChannels(slot, channelSources, scratch, out, sampleFrames);
+			if (channelSources[0]->canSeek()){
+				publishPositions(snapshot, channelSources);
+				released = true;
+			}
+			if (released)
+				wakeWorker();
 		}
-	    sdkSetEvtSize(params[eOut], 1);
-		sdkSetEvtData(params[eOut], data);
-	}else if (sdkGetEvtData(params[eRate]) == eAudio){
+	}else if (snapshot.rate >= eStep && snapshot.rate <= eCubic){
+		// one draw per channel and segment, the rest is interpolation
+		struct Draw {
+			TemplateModule* module;
+			SamplerSlot* slot;
+			RandomSource** channelSources;
+			float operator() (int c) { return module->nextValue(*slot, *channelSources[c]); }
+		} draw = {this, &slot, channelSources};
+		if (lfoRate < eStep || lfoRate > eCubic)
+			lfo.restart();
+		lfo.setShape(INTERP_STEP + snapshot.rate - eStep);
+		lfo.setIncrement(snapshot.frequency / sampleRate);
+		if (!(snapshot.max > snapshot.min))
+			lfo.setLimits(0.f, 0.f);
+		else if (usesRange(snapshot.type))
+			lfo.setLimits(snapshot.min, snapshot.max);
+		else
+			lfo.setLimits(0.f, std::numeric_limits<float>::max());
 		int sampleFrames = sdkGetBlocSize();
-		sdkSetEvtSize(params[eOut], sampleFrames);
-		for (int i = 0; i < sampleFrames; i++){
-			float data;
-		    if(sdkGetEvtData(params[eMax]) > sdkGetEvtData(params[eMin])){
-		        data = distribution.value(sdkGetEvtData(params[eMin]), sdkGetEvtData(params[eMax]), 128);
-		        if(data == 0.0f){
-			        data = sdkGetEvtData(params[eMin]);
-		        }
-		    }else{
-		        data = 0.f;
-		    }
-			sdkSetEvtArrayData(params[eOut], i, data);
+		sdkSetEvtSize(params[eOut], sampleFrames * channels);
+		lfo.fill(sdkGetEvtDataAddr(params[eOut]), sampleFrames, channels, draw);
+	}
+	lfoRate = snapshot.rate;
+	if (underruns != underrunsShown){
+		sdkSetEvtData(params[eUnderruns], (TPrecision)underruns);
+		underrunsShown = underruns;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// parameter handoff
+
+// distribution type of every entry of the eType list box
+static const int listTypes[] = {
+	UNIFORM, LINEAR, TRIANGULAR, EXPONENTIAL, BILATERAL, GAUSSIAN, CAUCHY,
+	WEIBULL, GAUSSIAN_LEGACY, BETA, GAMMA, POISSON, BINOMIAL, GEOMETRIC,
+	DISCRETE, EMPIRICAL
+};
+
+static int typeFromList (int index)
+{
+	if (index < 0 || index >= (int)(sizeof(listTypes) / sizeof(listTypes[0])))
+		return UNIFORM;
+	return listTypes[index];
+}
+
+static int engineFromList (int index)
+{
+	switch (index){
+		case eSFMT: return ENGINE_SFMT;
+		case eXoshiro128p: return ENGINE_XOSHIRO128P;
+		case eXoshiro256ss: return ENGINE_XOSHIRO256SS;
+		case ePCG32: return ENGINE_PCG32;
+		case eSplitMix64: return ENGINE_SPLITMIX64;
+		case ePhilox: return ENGINE_PHILOX;
+		default: return ENGINE_MT19937;
+	}
+}
+
+// the inputs a type's derived constants depend on
+static int inputsOfType (int type)
+{
+	switch (type){
+		case LINEAR: return dirtyType;
+		case UNIFORM:
+		case TRIANGULAR: return dirtyType | dirtyRange;
+		case DISCRETE:
+		case EMPIRICAL: return dirtyType | dirtyWeights;
+		default: return dirtyType | dirtyShape;
+	}
+}
+
+// the number of the stream at seconds plus samples, both rounded to whole
+// samples; a float holds every integer below 2^24, so giving whole seconds
+// and the samples after them keeps any song position exact
+static uint64_t streamPosition (float seconds, float samples, double rate)
+{
+	double position = std::floor(seconds * rate + 0.5) + std::floor(samples + 0.5);
+	return (uint64_t)std::max(0.0, std::min(position, 9.0e18));
+}
+
+// reads the changed inputs from the host into edit
+void TemplateModule::readParams (int changed)
+{
+	if (changed & dirtyRate){
+		edit.rate = (int)sdkGetEvtData(params[eRate]);
+		edit.frequency = sdkGetEvtData(params[eFrequency]);
+	}
+	if (changed & dirtyEngine)
+		edit.engine = engineFromList((int)sdkGetEvtData(params[eEngine]));
+	if (changed & dirtyType)
+		edit.type = typeFromList((int)sdkGetEvtData(params[eType]));
+	if (changed & dirtyRange){
+		edit.min = sdkGetEvtData(params[eMin]);
+		edit.max = sdkGetEvtData(params[eMax]);
+	}
+	if (changed & dirtyShape){
+		edit.paramA = sdkGetEvtData(params[eParamA]);
+		edit.paramB = sdkGetEvtData(params[eParamB]);
+	}
+	if (changed & dirtyGeneration)
+		edit.generation = (int)sdkGetEvtData(params[eGeneration]);
+	if (changed & dirtyChannels)
+		edit.channels = std::max(1, std::min(MAX_CHANNELS, (int)(sdkGetEvtData(params[eChannels]) + 0.5f)));
+	if (changed & dirtyPosition){
+		edit.position = streamPosition(sdkGetEvtData(params[eSeconds]),
+			sdkGetEvtData(params[ePosition]), sampleRate);
+		edit.seeks++;
+	}
+	if (changed & dirtyWeights){
+		int count = sdkGetEvtSize(params[eWeights]);
+		weights.resize(count);
+		for (int i = 0; i < count; i++){
+			weights[i] = sdkGetEvtArrayData(params[eWeights], i);
+		}
+	}
+}
+
+// publishes edit, under a new epoch, and a new revision when the values
+// change, to onProcess and to the worker, with the sources of its
+// channels made first; the worker only runs while background generation
+// is selected at audio rate and the block size is known, and is stopped
+// while its ring is replaced
+void TemplateModule::publishParams (int changed)
+{
+	bool wanted = edit.generation == eBackground && edit.rate == eAudio
+			&& prefillFrames > 0;
+	int chunkSize = wanted ? prefillFrames * edit.channels : 0;
+	bool fits = chunkSize == (edit.ring ? edit.ring->getChunkSize() : 0);
+	if (!wanted || !fits)
+		stopWorker();
+	if (!fits)
+		replaceRing(chunkSize);
+	growSources(sources[edit.engine], edit.channels, edit.engine, instanceStream, 0);
+	if (wanted)
+		growSources(workerSources[edit.engine], edit.channels, edit.engine,
+			instanceStream, edit.engine == ENGINE_PHILOX ? 0 : MAX_CHANNELS);
+
+	edit.epoch++;
+	if (changed & dirtyValues)
+		edit.revision++;
+	publishSlot(audio, changed);
+	if (prefill){
+		publishSlot(*prefill, changed);
+		std::lock_guard<std::mutex> lock(workerLock);
+		workerPending.store(true, std::memory_order_relaxed);
+		workerWake.notify_one();
+	}
+	if (wanted && !worker.joinable())
+		startWorker();
+	freeRetiredRings();
+}
+
+// a set whose slots all hold edit and still need configuring
+void TemplateModule::initSlots (SlotSet& set)
+{
+	for (int i = 0; i < 3; i++){
+		set.dirty[i] = dirtyAll;
+	}
+	set.slotA.snapshot = edit;
+	set.slotB.snapshot = edit;
+	set.slotC.snapshot = edit;
+}
+
+// brings the back slot of set up to date with edit and publishes it; the
+// derived constants are only recomputed when an input of the active type
+// changed since that slot was last configured
+void TemplateModule::publishSlot (SlotSet& set, int changed)
+{
+	for (int i = 0; i < 3; i++){
+		set.dirty[i] |= changed;
+	}
+	int index = set.slots.getBackIndex();
+	SamplerSlot& slot = set.slots.back();
+	int pending = set.dirty[index];
+	set.dirty[index] = 0;
+
+	slot.snapshot = edit;
+	if (pending & inputsOfType(edit.type))
+		configureSlot(slot);
+	set.slots.publish();
+}
+
+// derived constants of the active type, from the slot's snapshot
+void TemplateModule::configureSlot (SamplerSlot& slot)
+{
+	const ParamSnapshot& snapshot = slot.snapshot;
+	Distribution& distribution = slot.distribution;
+	const float a = snapshot.paramA;
+	const float b = snapshot.paramB;
+	const int count = (int)weights.size();
+	const float* w = count > 0 ? &weights[0] : 0;
+
+	switch (snapshot.type){
+		case UNIFORM:
+			if (snapshot.max > snapshot.min)
+				distribution.doUniform(snapshot.min, snapshot.max);
+			break;
+		case TRIANGULAR:
+			if (snapshot.max > snapshot.min){
+				float temp = snapshot.min + ((snapshot.max - snapshot.min) * 0.5f);
+				distribution.doTriangular(snapshot.min, temp, snapshot.max);
+			}
+			break;
+		case EXPONENTIAL: distribution.doExponential(a * 5.f); break;
+		case BILATERAL: distribution.doBilateral(a); break;
+		case GAUSSIAN: distribution.doGaussian(a, b); break;
+		case GAUSSIAN_LEGACY: distribution.doGaussianLegacy(a, b); break;
+		case CAUCHY: distribution.doCauchy(a, b); break;
+		case WEIBULL: distribution.doWeibull((a * 0.99f) + 0.01, b); break;
+		case BETA: distribution.doBeta(a * 10.f, b * 10.f); break;
+		case GAMMA: distribution.doGamma(a * 10.f, b); break;
+		case POISSON: distribution.doPoisson(a * 100.f); break;
+		case BINOMIAL: distribution.doBinomial((int)(b * 100.f + 0.5f), a); break;
+		case GEOMETRIC: distribution.doGeometric(a); break;
+		case DISCRETE: distribution.doDiscrete(w, count); break;
+		case EMPIRICAL: distribution.doEmpirical(w, count); break;
+		default: break;
+	}
+	distribution.setType(snapshot.type);
+}
+
+// one value in [min, max] of the slot drawn from channelSource, 0 for an
+// empty range
+float TemplateModule::nextValue (SamplerSlot& slot, RandomSource& channelSource)
+{
+	if (slot.snapshot.max > slot.snapshot.min){
+		slot.distribution.setSource(channelSource);
+		return slot.distribution.value(slot.snapshot.min, slot.snapshot.max, 128);
+	}
+	return 0.f;
+}
+
+// frames samples of every channel of the slot, interleaved by frame into
+// out; each channel is drawn from its own source into channelScratch,
+// sized by the callbacks for one block, and a longer block is done in
+// several runs so that nothing is allocated here
+void TemplateModule::fillChannels (SamplerSlot& slot, RandomSource** channelSources,
+	std::vector<float>& channelScratch, float* out, int frames)
+{
+	const ParamSnapshot& snapshot = slot.snapshot;
+	const int channels = snapshot.channels;
+	if (channels == 1){
+		slot.distribution.setSource(*channelSources[0]);
+		slot.distribution.dropBits();
+		slot.distribution.fill(out, frames, snapshot.min, snapshot.max);
+		return;
+	}
+	const int run = (int)channelScratch.size();
+	if (run == 0){
+		std::fill(out, out + frames * channels, 0.f);
+		return;
+	}
+	float* block = &channelScratch[0];
+	for (int c = 0; c < channels; c++){
+		slot.distribution.setSource(*channelSources[c]);
+		slot.distribution.dropBits();
+		for (int start = 0; start < frames; start += run){
+			int length = std::min(run, frames - start);
+			slot.distribution.fill(block, length, snapshot.min, snapshot.max);
+			float* channel = out + start * channels + c;
+			for (int i = 0; i < length; i++){
+				channel[i * channels] = block[i];
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// background generation
+
+// true when the chunk the ring gives to read was made from where the
+// channels' streams stand; always for engines that cannot seek, whose
+// positions are all 0
+static bool startsHere (const ChunkRing& ring, RandomSource** channelSources, int channels)
+{
+	const uint64_t* starts = ring.readMarks();
+	for (int c = 0; c < channels; c++){
+		if (starts[c] != channelSources[c]->tell())
+			return false;
+	}
+	return true;
+}
+
+// copies the oldest prefilled block of the snapshot's revision that starts
+// where channelSources stand to out, and moves them to its end, dropping
+// the blocks before it; false, counted as an underrun, when there is none.
+// released tells whether a chunk was freed
+bool TemplateModule::takePrefilled (TPrecision* out, int frames, const ParamSnapshot& snapshot,
+	RandomSource** channelSources, bool& released)
+{
+	ChunkRing* ring = snapshot.ring;
+	const int channels = snapshot.channels;
+	int count = frames * channels;
+	if (!ring || ring->getChunkSize() != count)
+		return false;
+	int chunkRevision;
+	const float* chunk;
+	while ((chunk = ring->readChunk(chunkRevision)) != 0
+			&& (chunkRevision != snapshot.revision || !startsHere(*ring, channelSources, channels))){
+		ring->releaseChunk();
+		released = true;
+	}
+	if (chunk != 0){
+		std::copy(chunk, chunk + count, out);
+		const uint64_t* ends = ring->readMarks() + MAX_CHANNELS;
+		for (int c = 0; c < channels; c++){
+			channelSources[c]->seek(ends[c]);
+		}
+		ring->releaseChunk();
+		released = true;
+	}else{
+		underruns++;
+	}
+	return chunk != 0;
+}
+
+// where channelSources stand after onProcess's block, for the worker to
+// catch up with; a sequence number, odd while the positions are written,
+// lets the worker tell a consistent set from a torn one without locking:
+// a position it loads from a later write also makes it load the later
+// sequence number
+void TemplateModule::publishPositions (const ParamSnapshot& snapshot, RandomSource** channelSources)
+{
+	unsigned seq = positionsSeq.load(std::memory_order_relaxed);
+	positionsSeq.store(seq + 1, std::memory_order_relaxed);
+	positionsRevision.store(snapshot.revision, std::memory_order_release);
+	for (int c = 0; c < snapshot.channels; c++){
+		audioPositions[c].store(channelSources[c]->tell(), std::memory_order_release);
+	}
+	positionsSeq.store(seq + 2, std::memory_order_release);
+}
+
+// the positions onProcess published for the snapshot's revision; false
+// when it has published none yet, or was writing them
+bool TemplateModule::readPositions (const ParamSnapshot& snapshot, uint64_t* positions)
+{
+	unsigned seq = positionsSeq.load(std::memory_order_acquire);
+	if (seq & 1)
+		return false;
+	bool current = positionsRevision.load(std::memory_order_acquire) == snapshot.revision;
+	for (int c = 0; c < snapshot.channels; c++){
+		positions[c] = audioPositions[c].load(std::memory_order_acquire);
+	}
+	return current && positionsSeq.load(std::memory_order_relaxed) == seq;
+}
+
+// gives edit a new ring of chunkSize samples a chunk, or none for 0, with
+// the worker stopped; onProcess may still read the old one, which is kept
+// until it takes the next epoch
+void TemplateModule::replaceRing (int chunkSize)
+{
+	if (edit.ring){
+		RetiredRing retired = {edit.ring, edit.epoch + 1};
+		retiredRings.push_back(retired);
+	}
+	edit.ring = 0;
+	if (chunkSize > 0){
+		edit.ring = new ChunkRing();
+		edit.ring->allocate(PREFILL_CHUNKS, chunkSize, 2 * MAX_CHANNELS);
+	}
+}
+
+// frees the replaced rings onProcess has moved past; callback side
+void TemplateModule::freeRetiredRings ()
+{
+	int taken = audioEpoch.load(std::memory_order_acquire);
+	size_t kept = 0;
+	for (size_t i = 0; i < retiredRings.size(); i++){
+		if (taken >= retiredRings[i].epoch)
+			delete retiredRings[i].ring;
+		else
+			retiredRings[kept++] = retiredRings[i];
+	}
+	retiredRings.resize(kept);
+}
+
+// the worker only works ahead of the audio thread, which generates a
+// block itself when none is ready, so it gives way to every other thread
+static void lowerPriority (std::thread& thread)
+{
+#ifdef _WIN32
+	SetThreadPriority(thread.native_handle(), THREAD_PRIORITY_IDLE);
+#elif defined(SCHED_IDLE)
+	sched_param param;
+	param.sched_priority = 0;
+	pthread_setschedparam(thread.native_handle(), SCHED_IDLE, &param);
+#else
+	sched_param param;
+	int policy;
+	if (pthread_getschedparam(thread.native_handle(), &policy, &param) == 0){
+		param.sched_priority = sched_get_priority_min(policy);
+		pthread_setschedparam(thread.native_handle(), policy, &param);
+	}
+#endif
+}
+
+void TemplateModule::startWorker ()
+{
+	if (!prefill){
+		prefill = new SlotSet(*workerSources[edit.engine][0]);
+		initSlots(*prefill);
+		publishSlot(*prefill, dirtyAll);
+	}
+	workerRunning.store(true, std::memory_order_relaxed);
+	worker = std::thread(&TemplateModule::runWorker, this);
+	lowerPriority(worker);
+}
+
+void TemplateModule::stopWorker ()
+{
+	if (worker.joinable()){
+		{
+			std::lock_guard<std::mutex> lock(workerLock);
+			workerRunning.store(false, std::memory_order_relaxed);
+			workerWake.notify_one();
+		}
+		worker.join();
+	}
+}
+
+// tells the worker a chunk was freed or new positions were published,
+// and only notifies it when it waits; either the worker sees workerPending
+// or this sees workerWaiting. onProcess does not take the lock, so the
+// worker can miss this one wakeup, which costs it one block
+void TemplateModule::wakeWorker ()
+{
+	workerPending.store(true);
+	if (workerWaiting.load())
+		workerWake.notify_one();
+}
+
+// places the worker's streams, on an engine that can seek, where the next
+// block onProcess takes will start: at the positions it published for the
+// snapshot's revision, when they are not placed for that revision yet or
+// have fallen behind; returns whether they are placed
+bool TemplateModule::catchUp (const ParamSnapshot& snapshot, RandomSource** channelSources,
+	bool placed)
+{
+	uint64_t positions[MAX_CHANNELS];
+	if (!readPositions(snapshot, positions))
+		return placed;
+	bool behind = !placed;
+	for (int c = 0; c < snapshot.channels; c++){
+		if (channelSources[c]->tell() < positions[c])
+			behind = true;
+	}
+	if (behind){
+		for (int c = 0; c < snapshot.channels; c++){
+			channelSources[c]->seek(positions[c]);
+		}
+	}
+	return true;
+}
+
+// keeps the ring full of blocks for the newest configuration, and waits
+// for a free chunk or a new configuration when there is nothing to do; it
+// never touches what onProcess uses. On an engine that can seek the
+// worker draws from the channels' own streams, seeks with onProcess and
+// marks each block with where it starts and ends in them, so that the
+// values are those inline generation gives and none is used twice
+void TemplateModule::runWorker ()
+{
+	int revision = -1;              // of the blocks being made
+	int seeks = -1;                 // Position changes applied
+	bool placed = false;            // streams placed for revision
+	while (workerRunning.load(std::memory_order_relaxed)){
+		prefill->slots.update();
+		SamplerSlot& slot = prefill->slots.front();
+		const ParamSnapshot& snapshot = slot.snapshot;
+		RandomSource** channelSources = workerSources[snapshot.engine];
+		const bool canSeek = channelSources[0]->canSeek();
+		if (snapshot.revision != revision){
+			revision = snapshot.revision;
+			placed = false;
+		}
+		if (snapshot.seeks != seeks){
+			// a seek from before the worker started is long behind onProcess
+			if (seeks >= 0 && canSeek){
+				for (int c = 0; c < snapshot.channels; c++){
+					channelSources[c]->seek(snapshot.position);
+				}
+				placed = true;
+			}
+			seeks = snapshot.seeks;
+		}
+
+		bool active = snapshot.generation == eBackground && snapshot.rate == eAudio
+				&& snapshot.max > snapshot.min && snapshot.ring;
+		float* chunk = active ? snapshot.ring->writeChunk() : 0;
+		if (chunk && canSeek)
+			placed = catchUp(snapshot, channelSources, placed);
+		if (chunk && (placed || !canSeek)){
+			uint64_t* marks = snapshot.ring->writeMarks();
+			for (int c = 0; c < snapshot.channels; c++){
+				marks[c] = channelSources[c]->tell();
+			}
+			fillChannels(slot, channelSources, workerScratch, chunk,
+				snapshot.ring->getChunkSize() / snapshot.channels);
+			for (int c = 0; c < snapshot.channels; c++){
+				marks[MAX_CHANNELS + c] = channelSources[c]->tell();
+			}
+			snapshot.ring->commitChunk(snapshot.revision);
+		}else{
+			std::unique_lock<std::mutex> lock(workerLock);
+			workerWaiting.store(true);
+			while (!workerPending.exchange(false)
+					&& workerRunning.load(std::memory_order_relaxed)){
+				workerWake.wait(lock);
+			}
+			workerWaiting.store(false, std::memory_order_relaxed);
 		}
 	}
 }
@@ -399,8 +1055,20 @@ void TemplateModule::onBringToFront() {}
 
 //-----------------------------------------------------------------------------
 // audio setup update
-void TemplateModule::onBlocSizeChange (int BlocSize) {}
-void TemplateModule::onSampleRateChange (double SampleRate) {}
+void TemplateModule::onBlocSizeChange (int BlocSize)
+{
+	// the worker's scratch is resized with it stopped; publishing gives it
+	// a ring of the new block size
+	stopWorker();
+	prefillFrames = BlocSize;
+	scratch.resize(BlocSize);
+	workerScratch.resize(BlocSize);
+	publishParams(0);
+}
+void TemplateModule::onSampleRateChange (double SampleRate)
+{
+	sampleRate = SampleRate;
+}
 
 //-----------------------------------------------------------------------------
 // recording 
@@ -56,9 +56,27 @@
 #include <iostream>
 #include <cmath>
 #include <limits>
+#include <algorithm>
+#include <vector>
 
-#include "mtrand.h"
+#include "randomsource.h"
 #include "distributions.h"
+#include "triplebuffer.h"
+#include "chunkring.h"
+#include "interpolator.h"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
 #include <time.h>
 //-----------------------------------------------------------------------------
 // defines and constantes
@@ -74,6 +92,14 @@
 	  eMax,
 	  eParamA,
 	  eParamB,
+	  eEngine,                      // added after the original parameters,
+	  eWeights,                     //   so saved patches keep their values
+	  eGeneration,
+	  eUnderruns,
+	  eChannels,
+	  eFrequency,
+	  ePosition,
+	  eSeconds,                     // whole seconds before ePosition
 
       eNumParams
   };
@@ -82,16 +108,105 @@
       eButton = 0,
       eControl,
 	  eAudio,
+	  eStep,                        // new values at eFrequency, held
+	  eLinear,                      //   or interpolated
+	  eCosine,
+	  eCubic,
 
       eNumRates
   };
 
+    enum EEngines {
+      eMT19937 = 0,
+      eSFMT,
+      eXoshiro128p,
+      eXoshiro256ss,
+      ePCG32,
+      eSplitMix64,
+      ePhilox,
+
+      eNumEngines
+  };
+
+    enum EGenerations {
+      eInline = 0,
+      eBackground,
+
+      eNumGenerations
+  };
+
+    // inputs changed since a slot was last configured
+    enum EDirty {
+      dirtyRate    = 1 << 0,
+      dirtyEngine  = 1 << 1,
+      dirtyType    = 1 << 2,
+      dirtyRange   = 1 << 3,
+      dirtyShape   = 1 << 4,
+      dirtyWeights = 1 << 5,
+      dirtyGeneration = 1 << 6,
+      dirtyChannels = 1 << 7,
+      dirtyPosition = 1 << 8,
+
+      dirtyAll     = (1 << 9) - 1,
+
+      // the inputs the generated values depend on
+      dirtyValues  = dirtyEngine | dirtyType | dirtyRange | dirtyShape
+                   | dirtyWeights | dirtyChannels | dirtyPosition
+  };
+
+#define MAX_CHANNELS (32)           // independent streams of one module
+#if 2 * MAX_CHANNELS > RANDOM_SUBSTREAMS
+#error "the audio and the worker channels need a substream each"
+#endif
+
+#define PREFILL_CHUNKS (4)          // audio blocks the worker keeps ready
+
 //-----------------------------------------------------------------------------
 // structures and typedef
 //-----------------------------------------------------------------------------
 
 // structures and typedef goes here
 
+// the inputs as read by the callbacks, rate, engine and type decoded;
+// epoch counts the configurations published, revision the changes of the
+// dirtyValues inputs, seeks the changes of position, the stream number
+// eSeconds and ePosition give, and ring is where the worker puts blocks of
+// this configuration, 0 when it does not run
+struct ParamSnapshot {
+	int rate, engine, type, generation, channels, epoch, revision, seeks;
+	float min, max, paramA, paramB, frequency;
+	uint64_t position;
+	ChunkRing* ring;
+};
+
+// a ring the callbacks replaced, freed once onProcess has used a
+// configuration of epoch or later
+struct RetiredRing {
+	ChunkRing* ring;
+	int epoch;
+};
+
+// one configuration handed from the callbacks to onProcess: the inputs
+// and a distribution with the constants derived from them
+struct SamplerSlot {
+	SamplerSlot (RandomSource& source) : distribution(source) {}
+
+	ParamSnapshot snapshot;
+	Distribution distribution;
+};
+
+// three slots handed from the callbacks to one reader thread, and what
+// changed since each of them was last configured
+struct SlotSet {
+	SlotSet (RandomSource& source)
+		: slotA(source), slotB(source), slotC(source),
+		  slots(&slotA, &slotB, &slotC) {}
+
+	SamplerSlot slotA, slotB, slotC;
+	TripleBuffer<SamplerSlot> slots;  // the reader uses slots.front() only
+	int dirty[3];                     // EDirty flags, by slot index
+};
+
 //-----------------------------------------------------------------------------
 // class definition
 //-----------------------------------------------------------------------------
@@ -182,11 +297,58 @@ protected:
 	// parameters events
 	UsineEventPtr params[eNumParams];
 	
-	MTRand mt;
+	// one source per engine and channel, on substream c of instanceStream
+	// (MAX_CHANNELS + c for the prefill worker's, unless the engine can
+	// seek, see runWorker()), made by the callbacks before the first
+	// configuration that uses it is published and kept to the end, so that
+	// switching engines back resumes the streams; the slots' distributions
+	// are built on the first and switched to the channel they draw for
+	uint64_t instanceStream;
+	RandomSource* sources[NUM_ENGINES][MAX_CHANNELS];
+	RandomSource* workerSources[NUM_ENGINES][MAX_CHANNELS];
+
+    // callback side: the inputs
+    ParamSnapshot edit;
+    std::vector<float> weights;     // copy of eWeights for the tables
+
+    SlotSet audio;                  // read by onProcess
+    SlotSet* prefill;               // read by the prefill worker, made when
+                                    //   it first starts
+    std::atomic<int> triggers;      // eTrigger presses not yet answered
+
+    // background generation: while it is selected at audio rate the worker
+    // fills edit.ring with audio blocks for onProcess, which generates
+    // inline when none is ready; with nothing to do the worker waits on
+    // workerWake
+    std::thread worker;
+    std::mutex workerLock;
+    std::condition_variable workerWake;
+    std::atomic<bool> workerRunning;
+    std::atomic<bool> workerPending;   // set before every workerWake notify
+    std::atomic<bool> workerWaiting;   // the worker is in workerWake.wait()
+    int underruns;                  // blocks generated inline, onProcess only
+    int underrunsShown;             // last value sent to eUnderruns
+    int prefillFrames;              // block size of the ring's chunks
+    std::atomic<int> audioEpoch;    // epoch of the slot onProcess last took
+
+    // where onProcess's streams stood after its last background block, on
+    // an engine that can seek, see publishPositions()
+    std::atomic<unsigned> positionsSeq;
+    std::atomic<int> positionsRevision;
+    std::atomic<uint64_t> audioPositions[MAX_CHANNELS];
+    std::vector<RetiredRing> retiredRings;  // callback side
+
+    // one channel's block before it is interleaved, for onProcess and for
+    // the worker
+    std::vector<float> scratch;
+    std::vector<float> workerScratch;
+
+    int seeksTaken;                 // Position changes applied, onProcess only
 
-	int type, rate;
-    Distribution distribution;
-    float min, max, paramA, paramB;
+    // held and interpolated rates, onProcess only
+    Interpolator lfo;
+    int lfoRate;                    // rate of the previous block
+    double sampleRate;
 	
     // protected members goes here
   
@@ -196,6 +358,25 @@ protected:
 private:  
 
     // private methodes goes here
+	void readParams (int changed);
+	void publishParams (int changed);
+	void initSlots (SlotSet& set);
+	void publishSlot (SlotSet& set, int changed);
+	void configureSlot (SamplerSlot& slot);
+	float nextValue (SamplerSlot& slot, RandomSource& channelSource);
+	void fillChannels (SamplerSlot& slot, RandomSource** channelSources,
+		std::vector<float>& channelScratch, float* out, int frames);
+	bool takePrefilled (TPrecision* out, int frames, const ParamSnapshot& snapshot,
+		RandomSource** channelSources, bool& released);
+	void publishPositions (const ParamSnapshot& snapshot, RandomSource** channelSources);
+	bool readPositions (const ParamSnapshot& snapshot, uint64_t* positions);
+	bool catchUp (const ParamSnapshot& snapshot, RandomSource** channelSources, bool placed);
+	void replaceRing (int chunkSize);
+	void freeRetiredRings ();
+	void startWorker ();
+	void stopWorker ();
+	void wakeWorker ();
+	void runWorker ();
 
 }; // class TemplateModule
 
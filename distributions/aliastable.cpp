@@ -0,0 +1,113 @@
+//
+// Walker alias table sampler, see aliastable.h for information.
+//
+
+#include "aliastable.h"
+
+
+//////////////////////////////
+//
+// AliasTable::AliasTable -- an empty table samples 0 until build() is
+//     called.
+//
+
+AliasTable::AliasTable() {
+   size = 0;
+   capacity = 0;
+   threshold = 0;
+   alias = 0;
+   scaled = 0;
+   work = 0;
+}
+
+
+
+//////////////////////////////
+//
+// AliasTable::~AliasTable --
+//
+
+AliasTable::~AliasTable() {
+   delete [] threshold;
+   delete [] alias;
+   delete [] scaled;
+   delete [] work;
+}
+
+
+
+//////////////////////////////
+//
+// AliasTable::build -- Vose's method: columns with less than the average
+//     weight are topped up from one with more, which keeps the rest of
+//     its weight and goes back on the small or the large list.
+//
+
+void AliasTable::build(const float* weights, int n) {
+   if (n < 0) {
+      n = 0;
+   }
+   if ((uint32_t)n > capacity) {
+      delete [] threshold;
+      delete [] alias;
+      delete [] scaled;
+      delete [] work;
+      capacity = n;
+      threshold = new uint32_t[capacity];
+      alias = new uint32_t[capacity];
+      scaled = new double[capacity];
+      work = new uint32_t[capacity];
+   }
+   size = n;
+
+   double total = 0.0;
+   for (int i=0; i<n; i++) {
+      double w = weights[i];
+      scaled[i] = (w > 0.0) ? w : 0.0;      // also maps nan to 0
+      total += scaled[i];
+   }
+   if (!(total > 0.0) || total > 1e300) {
+      for (int i=0; i<n; i++) {
+         scaled[i] = 1.0;
+      }
+      total = n;
+   }
+
+   // small columns are stacked from the front of work, large ones from
+   // the back
+   int small = 0;
+   int large = n;
+   for (int i=0; i<n; i++) {
+      scaled[i] *= n / total;
+      if (scaled[i] < 1.0) {
+         work[small++] = i;
+      } else {
+         work[--large] = i;
+      }
+   }
+
+   while (small > 0 && large < n) {
+      uint32_t s = work[--small];
+      uint32_t l = work[large++];
+      threshold[s] = (uint32_t)(scaled[s] * 4294967296.0);
+      alias[s] = l;
+      scaled[l] -= 1.0 - scaled[s];
+      if (scaled[l] < 1.0) {
+         work[small++] = l;
+      } else {
+         work[--large] = l;
+      }
+   }
+
+   // what is left is full, up to rounding
+   while (small > 0) {
+      uint32_t s = work[--small];
+      threshold[s] = 0xffffffffU;
+      alias[s] = s;
+   }
+   while (large < n) {
+      uint32_t l = work[large++];
+      threshold[l] = 0xffffffffU;
+      alias[l] = l;
+   }
+}
@@ -0,0 +1,57 @@
+//
+// Walker alias table sampler for a discrete distribution given by weights.
+//
+// build() turns n non-negative weights into n columns, each holding a
+// threshold and an alias (Vose's O(n) construction). A 32-bit random word
+// w is multiplied by n: the high half of the 64-bit product selects the
+// column and the low half, which is uniform within the column, is compared
+// with its threshold to pick the column's own index or its alias. So a
+// sample costs one word, a multiply and two table reads, whatever n.
+//
+// The thresholds are rounded to 2^-32 and the comparison has a resolution
+// of n / 2^32, so probabilities are exact to about n 2^-32.
+//
+// Negative and nan weights count as 0; if all are 0 every index is equally
+// likely. The arrays only grow, so rebuilding with the same or fewer
+// weights does not allocate.
+//
+
+#ifndef ALIASTABLE_H_INCLUDED
+#define ALIASTABLE_H_INCLUDED
+
+#include <stdint.h>
+
+
+class AliasTable {
+   public:
+                    AliasTable    ();
+                   ~AliasTable    ();
+
+      void          build         (const float* weights, int n);
+      int           getSize       (void) const { return size; }
+
+      // index in [0, n) for a 32-bit random word, 0 when empty
+      uint32_t      sample        (uint32_t word) const {
+         if (size == 0) {
+            return 0;
+         }
+         uint64_t x = (uint64_t)word * size;
+         uint32_t i = (uint32_t)(x >> 32);
+         return (uint32_t)x < threshold[i] ? i : alias[i];
+      }
+
+   protected:
+      uint32_t      size;           // number of columns
+      uint32_t      capacity;       // allocated columns
+      uint32_t*     threshold;      // keep the column below this
+      uint32_t*     alias;          // index taken above it
+      double*       scaled;         // build(): weights times n / total
+      uint32_t*     work;           // build(): small and large columns
+
+   private:
+      AliasTable    (const AliasTable&);
+      void          operator=     (const AliasTable&);
+};
+
+
+#endif  /* ALIASTABLE_H_INCLUDED */
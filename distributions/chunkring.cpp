@@ -0,0 +1,66 @@
+//
+// Lock-free ring of sample chunks, see chunkring.h for information.
+//
+
+#include "chunkring.h"
+
+
+//////////////////////////////
+//
+// ChunkRing::ChunkRing -- an unallocated ring is always empty and always
+//     full.
+//
+
+ChunkRing::ChunkRing() : head(0), tail(0) {
+   chunks = 0;
+   chunkSize = 0;
+   samples = 0;
+   epochs = 0;
+   markCount = 0;
+   marks = 0;
+}
+
+
+
+//////////////////////////////
+//
+// ChunkRing::~ChunkRing --
+//
+
+ChunkRing::~ChunkRing() {
+   delete [] samples;
+   delete [] epochs;
+   delete [] marks;
+}
+
+
+
+//////////////////////////////
+//
+// ChunkRing::allocate -- empties the ring and makes room for aChunks
+//     chunks of aChunkSize samples and aMarks marks.  Only reallocates
+//     when the size changes.
+//
+
+void ChunkRing::allocate(int aChunks, int aChunkSize, int aMarks) {
+   if (aChunks < 0 || aChunkSize <= 0) {
+      aChunks = 0;
+      aChunkSize = 0;
+   }
+   if (aMarks < 0) {
+      aMarks = 0;
+   }
+   if (aChunks != chunks || aChunkSize != chunkSize || aMarks != markCount) {
+      delete [] samples;
+      delete [] epochs;
+      delete [] marks;
+      samples = aChunks > 0 ? new float[aChunks * aChunkSize] : 0;
+      epochs = aChunks > 0 ? new int[aChunks] : 0;
+      marks = aChunks > 0 && aMarks > 0 ? new uint64_t[aChunks * aMarks] : 0;
+      chunks = aChunks;
+      chunkSize = aChunkSize;
+      markCount = aMarks;
+   }
+   head.store(0, std::memory_order_relaxed);
+   tail.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,88 @@
+//
+// Lock-free ring of fixed-size sample chunks from one producer thread to
+// one consumer thread.
+//
+// The producer asks writeChunk() for the next free chunk, fills it and
+// hands it over with commitChunk(); the consumer asks readChunk() for the
+// oldest full one and gives it back with releaseChunk(). Each side only
+// stores its own counter, with release ordering, and loads the other's
+// with acquire ordering, so neither side waits and the consumer always
+// sees a completely written chunk. A full ring makes writeChunk() return 0,
+// an empty one readChunk().
+//
+// Every chunk carries an epoch, chosen by the producer, which lets the
+// consumer recognise and drop chunks made for a configuration it no longer
+// uses, and optionally a few marks, 64-bit words the producer writes
+// before committing, such as where in its streams the chunk was made.
+//
+// allocate() must only be called while neither side is using the ring.
+//
+
+#ifndef CHUNKRING_H_INCLUDED
+#define CHUNKRING_H_INCLUDED
+
+#include <atomic>
+#include <stdint.h>
+
+
+class ChunkRing {
+   public:
+                    ChunkRing     ();
+                   ~ChunkRing     ();
+
+      void          allocate      (int aChunks, int aChunkSize,
+                                     int aMarks = 0);
+      int           getChunkSize  (void) const { return chunkSize; }
+      int           getMarkCount  (void) const { return markCount; }
+
+      // producer side
+      float*        writeChunk    (void) {
+         unsigned h = head.load(std::memory_order_relaxed);
+         if (h - tail.load(std::memory_order_acquire) >= (unsigned)chunks) {
+            return 0;
+         }
+         return samples + (h % chunks) * chunkSize;
+      }
+      uint64_t*     writeMarks    (void) {  // of the chunk writeChunk() gave
+         return marks + (head.load(std::memory_order_relaxed) % chunks) * markCount;
+      }
+      void          commitChunk   (int epoch) {
+         unsigned h = head.load(std::memory_order_relaxed);
+         epochs[h % chunks] = epoch;
+         head.store(h + 1, std::memory_order_release);
+      }
+
+      // consumer side
+      const float*  readChunk     (int& epoch) {
+         unsigned t = tail.load(std::memory_order_relaxed);
+         if (head.load(std::memory_order_acquire) == t) {
+            return 0;
+         }
+         epoch = epochs[t % chunks];
+         return samples + (t % chunks) * chunkSize;
+      }
+      const uint64_t* readMarks   (void) const {  // of the chunk readChunk() gave
+         return marks + (tail.load(std::memory_order_relaxed) % chunks) * markCount;
+      }
+      void          releaseChunk  (void) {
+         tail.store(tail.load(std::memory_order_relaxed) + 1,
+               std::memory_order_release);
+      }
+
+   protected:
+      int           chunks;         // number of chunks, 0 when unallocated
+      int           chunkSize;      // samples per chunk
+      float*        samples;        // chunks * chunkSize
+      int*          epochs;         // by chunk
+      int           markCount;      // marks per chunk
+      uint64_t*     marks;          // chunks * markCount
+      std::atomic<unsigned> head;   // chunks committed, producer only stores
+      std::atomic<unsigned> tail;   // chunks released, consumer only stores
+
+   private:
+      ChunkRing     (const ChunkRing&);
+      void          operator=     (const ChunkRing&);
+};
+
+
+#endif  /* CHUNKRING_H_INCLUDED */
@@ -10,7 +10,8 @@
 //                Winsor and DeLisa, "Computer Music in C", pp. 177-205
 //
 
-#include "Distributions.h"
+#include "distributions.h"
+#include "samplers.h"
 #include <time.h>
 #include <stdlib.h>
 #include <limits.h>
@@ -26,30 +27,153 @@
 
 //////////////////////////////
 //
-// Distribution::Distribution --
+// CauchyQuantile, WeibullQuantile -- quantile functions of the standard
+//     Cauchy distribution and of the Weibull distribution with scale 1,
+//     tabulated by the QuantileTable members of Distribution.
 //
 
-Distribution::Distribution(void) {
-   seedValue = time(NULL);   // time in seconds since 00:00:00 GMT, 1 Jan 1970
-   srand(seedValue);
-   doBeta(0.5, 0.5);
-   doCauchy(1.0, 0.0);
-   doExponential(1.0);
-   doBilateral(1.0);
-   doTriangular(0.0, 0.5, 1.0);
-   doUniform(0.0, 1.0);
-   distributionType = 0;
+static double CauchyQuantile(double u, double) {
+   const double pi = 3.14159265358979323846;
+   return tan(pi * (u - 0.5));
 }
 
-Distribution::Distribution(int aSeed) {
-   seedValue = aSeed;
-   srand(seedValue);
+static double WeibullQuantile(double u, double inverseShape) {
+   return pow(log(1.0/(1.0-u)), inverseShape);
+}
+
+
+
+//////////////////////////////
+//
+// NormalCdf, NormalQuantile -- standard normal distribution function and
+//     its inverse, the latter from Peter Acklam's rational approximation
+//     (relative error below 1.2e-9).
+//
+
+static double NormalCdf(double z) {
+   return 0.5 * erfc(-z * 0.70710678118654752440);
+}
+
+static double NormalQuantile(double p) {
+   static const double a[6] = { -3.969683028665376e+01, 2.209460984245205e+02,
+      -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01,
+       2.506628277459239e+00 };
+   static const double b[5] = { -5.447609879822406e+01, 1.615858368580409e+02,
+      -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01 };
+   static const double c[6] = { -7.784894002430293e-03, -3.223964580411365e-01,
+      -2.400758277161838e+00, -2.549671324555540e+00, 4.374664141464968e+00,
+       2.938163982698783e+00 };
+   static const double d[4] = { 7.784695709041462e-03, 3.224671290700398e-01,
+       2.445134137142996e+00, 3.754408661907416e+00 };
+   const double plow = 0.02425;
+
+   if (p < plow || p > 1.0 - plow) {
+      double q = sqrt(-2.0 * log(p < plow ? p : 1.0 - p));
+      double x = (((((c[0]*q+c[1])*q+c[2])*q+c[3])*q+c[4])*q+c[5]) /
+                 ((((d[0]*q+d[1])*q+d[2])*q+d[3])*q+1.0);
+      return p < plow ? x : -x;
+   }
+   double q = p - 0.5;
+   double r = q * q;
+   return (((((a[0]*r+a[1])*r+a[2])*r+a[3])*r+a[4])*r+a[5])*q /
+          (((((b[0]*r+b[1])*r+b[2])*r+b[3])*r+b[4])*r+1.0);
+}
+
+
+
+//////////////////////////////
+//
+// CauchyCdf -- standard Cauchy distribution function, written so that
+//     the lower tail keeps its relative precision.
+//
+
+static double CauchyCdf(double z) {
+   const double pi = 3.14159265358979323846;
+   if (z < 0.0) {
+      return -atan(1.0 / z) / pi;
+   }
+   return 0.5 + atan(z) / pi;
+}
+
+
+
+//////////////////////////////
+//
+// LaplaceCdf, LaplaceQuantile -- Laplace distribution with rate lambda.
+//
+
+static double LaplaceCdf(double x, double lambda) {
+   if (x < 0.0) {
+      return 0.5 * exp(lambda * x);
+   }
+   return 1.0 - 0.5 * exp(-lambda * x);
+}
+
+static double LaplaceQuantile(double u, double lambda) {
+   if (u < 0.5) {
+      return log(2.0 * u) / lambda;
+   }
+   return -log(2.0 * (1.0 - u)) / lambda;
+}
+
+
+
+//////////////////////////////
+//
+// TriangularCdf -- triangular distribution with its peak at 0, falling
+//     to 0 at -lower and upper; x must lie in between.
+//
+
+static double TriangularCdf(double x, double lower, double upper) {
+   double width = lower + upper;
+   if (x < 0.0 || upper == 0.0) {
+      return (x + lower) * (x + lower) / (width * lower);
+   }
+   return 1.0 - (upper - x) * (upper - x) / (width * upper);
+}
+
+
+
+static double clampValue(double x, double min, double max) {
+   if (!(x >= min)) {      // also maps nan to min
+      return min;
+   }
+   return x > max ? max : x;
+}
+
+static inline float clampSample(float x, float min, float max) {
+   x = (x >= min) ? x : min;
+   return (x <= max) ? x : max;
+}
+
+
+
+//////////////////////////////
+//
+// Distribution::Distribution --
+//
+
+Distribution::Distribution(RandomSource& aSource) {
+   source = &aSource;
+   seedValue = 0;
+   signBits = 0;
+   signCount = 0;
+   truncValid = false;
    doBeta(0.5, 0.5);
-   doCauchy(1.0, 0.0);
+   cauchy_spread = 1.0;          // the quantile tables are only built
+   cauchy_mean = 0.0;            // when their type is selected
    doExponential(1.0);
+   doGamma(1.0, 1.0);
    doBilateral(1.0);
+   doBinomial(10, 0.5);
+   doGeometric(0.5);
+   doPoisson(1.0);
+   doGaussian(1.0, 0.0);
    doTriangular(0.0, 0.5, 1.0);
+   weibull_inv_t = 1.0;
+   weibull_s = 1.0;
    doUniform(0.0, 1.0);
+   distributionType = 0;
 }
 
 
@@ -65,24 +189,21 @@ Distribution::~Distribution() { }
 
 //////////////////////////////
 //
-// Distribution::doDistributions --
+// Distribution::doDistributions -- parameters outside their range are
+//     clamped into it, since a bad value from the host must not stop it.
 //
 
 void Distribution::doBeta(void)        { setType(BETA       ); }
 void Distribution::doBeta(float Avalue, float Bvalue) { 
-   if (Avalue <= 0) {
-      cerr << "Beta distribution parameter a = " << Avalue 
-           << " cannot be negative or zero." << endl;
-      exit(1);
-   }
-   if (Bvalue <= 0) {
-      cerr << "Beta distribution parameter b = " << Bvalue 
-           << " cannot be negative or zero." << endl;
-      exit(1);
-   }
+   Avalue = (float)clampValue(Avalue, SHAPE_MIN, HUGE_VAL);
+   Bvalue = (float)clampValue(Bvalue, SHAPE_MIN, HUGE_VAL);
    
+   beta_a = Avalue;
+   beta_b = Bvalue;
    beta_inv_a = 1.0/Avalue;
    beta_inv_b = 1.0/Bvalue;
+   setGammaShape(beta_gamma_a, Avalue);
+   setGammaShape(beta_gamma_b, Bvalue);
    doBeta();
 }
 
@@ -92,6 +213,32 @@ void Distribution::doBilateral(float aLambda) {
    doBilateral();
 }
 
+void Distribution::doBinomial(void)    { setType(BINOMIAL   ); }
+void Distribution::doBinomial(int aTrials, float aProbability) {
+   if (aTrials < 0) {
+      aTrials = 0;
+   }
+   aProbability = (float)clampValue(aProbability, 0.0, 1.0);
+
+   BinomialShape& shape = binomial_shape;
+   shape.n    = aTrials;
+   shape.flip = aProbability > 0.5;
+   shape.p    = shape.flip ? 1.0 - aProbability : aProbability;
+   shape.q    = 1.0 - shape.p;
+   if (shape.n * shape.p >= BINOMIAL_INVERSION_MEAN) {
+      double spq = sqrt(shape.n * shape.p * shape.q);
+      shape.b     = 1.15 + 2.53 * spq;
+      shape.a     = -0.0873 + 0.0248 * shape.b + 0.01 * shape.p;
+      shape.c     = shape.n * shape.p + 0.5;
+      shape.alpha = (2.83 + 5.1 / shape.b) * spq;
+      shape.vr    = 0.92 - 4.2 / shape.b;
+      shape.m     = floor((shape.n + 1) * shape.p);
+      shape.h     = logFactorial(shape.m) + logFactorial(shape.n - shape.m);
+      shape.logRatio = log(shape.p / shape.q);
+   }
+   doBinomial();
+}
+
 void Distribution::doCauchy(void)      { setType(CAUCHY     ); }
 void Distribution::doCauchy(float aSpread, float aMean) { 
    cauchy_spread = aSpread;
@@ -99,12 +246,32 @@ void Distribution::doCauchy(float aSpread, float aMean) {
    doCauchy();
 }
 
+void Distribution::doDiscrete(void)    { setType(DISCRETE   ); }
+void Distribution::doDiscrete(const float* weights, int n) {
+   discreteTable.build(weights, n);
+   doDiscrete();
+}
+
+void Distribution::doEmpirical(void)   { setType(EMPIRICAL  ); }
+void Distribution::doEmpirical(const float* density, int n) {
+   empiricalTable.build(density, n);
+   doEmpirical();
+}
+
 void Distribution::doExponential(void) { setType(EXPONENTIAL); }
 void Distribution::doExponential(float aLambda) { 
    exponential_lambda = aLambda;
    doExponential();
 }
 
+void Distribution::doGamma(void)       { setType(GAMMA      ); }
+void Distribution::doGamma(float aShape, float aScale) {
+   aShape = (float)clampValue(aShape, SHAPE_MIN, HUGE_VAL);
+   setGammaShape(gamma_shape, aShape);
+   gamma_scale = aScale;
+   doGamma();
+}
+
 void Distribution::doGaussian(void)    { setType(GAUSSIAN   ); }
 void Distribution::doGaussian(float aDeviation, float aMean) {
    gaussian_deviation = aDeviation;
@@ -112,27 +279,49 @@ void Distribution::doGaussian(float aDeviation, float aMean) {
    doGaussian();
 }
 
+void Distribution::doGaussianLegacy(void) { setType(GAUSSIAN_LEGACY); }
+void Distribution::doGaussianLegacy(float aDeviation, float aMean) {
+   gaussian_deviation = aDeviation;
+   gaussian_mean = aMean;
+   doGaussianLegacy();
+}
+
+void Distribution::doGeometric(void)   { setType(GEOMETRIC  ); }
+void Distribution::doGeometric(float aProbability) {
+   aProbability = (float)clampValue(aProbability, PROBABILITY_MIN, 1.0);
+   geometric_p = aProbability;
+   geometric_log_q = log1p(-(double)aProbability);
+   doGeometric();
+}
+
 void Distribution::doLinear(void)      { setType(LINEAR     ); }
+
 void Distribution::doPoisson(void)     { setType(POISSON    ); }
+void Distribution::doPoisson(float aMean) {
+   aMean = (float)clampValue(aMean, 0.0, HUGE_VAL);
+
+   PoissonShape& shape = poisson_shape;
+   shape.mean = aMean;
+   if (aMean >= POISSON_INVERSION_MEAN) {
+      shape.logMean = log(shape.mean);
+      shape.b = 0.931 + 2.53 * sqrt(shape.mean);
+      shape.a = -0.059 + 0.02483 * shape.b;
+      shape.logInvAlpha = log(1.1239 + 1.1328 / (shape.b - 3.4));
+      shape.vr = 0.9277 - 3.6224 / (shape.b - 2.0);
+   }
+   doPoisson();
+}
 
 void Distribution::doTriangular(void)  { setType(TRIANGULAR ); }
 void Distribution::doTriangular(float aLowerLimit, float aMax,
   float anUpperLimit) { 
 
-   if (aMax < aLowerLimit) {
-      cerr << "Cannot have a max less than a lower limit in a" 
-           << " triangular distribution: " << endl 
-           << "   lower limit = " << aLowerLimit 
-           << "  max = " << aMax << endl;
-      exit(1);
-   }
-   if (anUpperLimit < aMax) {
-      cerr << "Cannot have a max greater than the upper limit in a" 
-           << " triangular distribution: " << endl 
-           << "   upper limit = " << anUpperLimit 
-           << "  max = " << aMax << endl;
-      exit(1);
+   if (anUpperLimit < aLowerLimit) {
+      float temp = aLowerLimit;
+      aLowerLimit = anUpperLimit;
+      anUpperLimit = temp;
    }
+   aMax = (float)clampValue(aMax, aLowerLimit, anUpperLimit);
 
    triangular_max = aMax;
    triangular_diffl = aMax - aLowerLimit;
@@ -143,9 +332,9 @@ void Distribution::doTriangular(float aLowerLimit, float aMax,
 void Distribution::doUniform(void)     { setType(UNIFORM    ); }
 void Distribution::doUniform(float aLowerLimit, float anUpperLimit) {
    if (aLowerLimit > anUpperLimit) {
-      cerr << "Cannot invert max and min in range: [" 
-           << aLowerLimit << ", " << anUpperLimit << "]." << endl;
-      exit(1);
+      float temp = aLowerLimit;
+      aLowerLimit = anUpperLimit;
+      anUpperLimit = temp;
    }
 
    uniform_low = aLowerLimit;
@@ -155,11 +344,7 @@ void Distribution::doUniform(float aLowerLimit, float anUpperLimit) {
 
 void Distribution::doWeibull(void)     { setType(WEIBULL    ); }
 void Distribution::doWeibull(float t, float s) { 
-   if (t <= 0) {
-      cerr << "t value: " << t << " of Weibull distribution must be > 0." 
-           << endl;
-      exit(1);
-   }
+   t = (float)clampValue(t, SHAPE_MIN, HUGE_VAL);
    weibull_inv_t = 1.0/t;
    weibull_s = s;
    doWeibull();
@@ -186,19 +371,57 @@ int Distribution::getType(void) {
 
 void Distribution::seed(int aSeed) {
    seedValue = aSeed;
-   srand(seedValue);
+   signCount = 0;
+   source->seed(static_cast<unsigned long>(seedValue));
+}
+
+
+
+//////////////////////////////
+//
+// Distribution::setSource -- draw from another engine from now on.  The
+//     sign bits left from the old one are dropped, so each source's
+//     numbers only ever reach the output drawn from it.
+//
+
+void Distribution::setSource(RandomSource& aSource) {
+   if (&aSource != source) {
+      source = &aSource;
+      signCount = 0;
+   }
+}
+
+
+
+//////////////////////////////
+//
+// Distribution::dropBits -- forget the sign bits left from earlier draws,
+//     so that after the source seeks the values only depend on where it
+//     is in its stream.
+//
+
+void Distribution::dropBits(void) {
+   signCount = 0;
 }
 
 
 
 //////////////////////////////
 //
-// Distribution::setType --
+// Distribution::setType -- also builds the quantile table of a Cauchy
+//     or Weibull distribution, when it is not built for its parameters.
 //
 
 int Distribution::setType(int newDistributionType) {
    int oldType = distributionType;
+   if (newDistributionType == CAUCHY && !cauchyTable.isBuilt()) {
+      cauchyTable.build(CauchyQuantile, 0.0);
+   } else if (newDistributionType == WEIBULL && (!weibullTable.isBuilt()
+         || weibullTable.getShape() != weibull_inv_t)) {
+      weibullTable.build(WeibullQuantile, weibull_inv_t);
+   }
    distributionType = newDistributionType;
+   truncValid = false;
    return oldType;
 }
 
@@ -215,14 +438,28 @@ float Distribution::value(void) {
          return BetaDistribution();
       case BILATERAL:
          return BilateralDistribution();
+      case BINOMIAL:
+         return BinomialDistribution();
       case CAUCHY:
          return CauchyDistribution();
+      case DISCRETE:
+         return DiscreteDistribution();
+      case EMPIRICAL:
+         return EmpiricalDistribution();
       case EXPONENTIAL:
          return ExponentialDistribution();
+      case GAMMA:
+         return GammaDistribution();
       case GAUSSIAN:
          return GaussianDistribution();
+      case GAUSSIAN_LEGACY:
+         return GaussianLegacyDistribution();
+      case GEOMETRIC:
+         return GeometricDistribution();
       case LINEAR:
          return LinearDistribution();
+      case POISSON:
+         return PoissonDistribution();
       case TRIANGULAR:
          return TriangularDistribution();
       case WEIBULL:
@@ -234,30 +471,90 @@ float Distribution::value(void) {
 }
 
 float Distribution::value(float min, float max, int numAttempts) {
-   if (min >= max) {
-      cerr << "Cannot invert the selection range: [" << min << ", "
-           << max << "]" << endl;
-      exit(1);
+   if (!(min < max)) {      // empty or reversed range: its lower end
+      return min;
    }
-   static float number;
-   static int counter;
-   
-   counter = 0;
-   number = value();
-   while (number < min || number > max) {
+   if (!truncValid || min != truncMin || max != truncMax) {
+      setTruncation(min, max);
+   }
+   if (!truncBounded) {
+      return value();
+   }
+
+   float number;
+   if (!truncInvert) {
+      // no invertible CDF: bounded rejection, clamped when it runs out
       number = value();
-      counter++;
-      if (counter > numAttempts) {
-         return 0.0;
+      for (int counter = 0; counter < numAttempts; counter++) {
+         if (number >= min && number <= max) {
+            return number;
+         }
+         number = value();
       }
+      return (float)clampValue(number, min, max);
    }
-   
-   return number;
+
+   if (!(truncHigh > truncLow)) {
+      return truncFallback;
+   }
+   if (truncReject) {
+      int attempts = numAttempts < TRUNCATION_ATTEMPTS ? numAttempts
+            : TRUNCATION_ATTEMPTS;
+      for (int counter = 0; counter < attempts; counter++) {
+         number = value();
+         if (number >= min && number <= max) {
+            return number;
+         }
+      }
+   }
+   return TruncatedDistribution();
 }
       
 
 
 
+//////////////////////////////
+//
+// Distribution::fill -- n values in [min, max] (counts ignore the range),
+//     as value(min, max, FILL_ATTEMPTS) would return them, with the type and engine selected
+//     once per block of FILL_BLOCK samples and the random words taken in
+//     bulk.
+//
+
+void Distribution::fill(float* out, int n, float min, float max) {
+   if (!(min < max)) {      // empty or reversed range: its lower end
+      for (int i=0; i<n; i++) {
+         out[i] = min;
+      }
+      return;
+   }
+   if (!truncValid || min != truncMin || max != truncMax) {
+      setTruncation(min, max);
+   }
+
+   if (truncInvert && !(truncHigh > truncLow)) {
+      for (int i=0; i<n; i++) {
+         out[i] = truncFallback;
+      }
+      return;
+   }
+
+   while (n > 0) {
+      int count = n < FILL_BLOCK ? n : FILL_BLOCK;
+      if (!truncInvert) {
+         fillRejection(out, count, FILL_ATTEMPTS);
+      } else if (truncReject) {
+         fillRejection(out, count, TRUNCATION_ATTEMPTS);
+      } else {
+         fillInverse(out, count);
+      }
+      out += count;
+      n -= count;
+   }
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////
 //
 // Private functions:
@@ -266,152 +563,192 @@ float Distribution::value(float min, float max, int numAttempts) {
 
 //////////////////////////////
 //
-// Distribution::BetaDistribution --
+// Distribution::BetaDistribution -- Johnk's method or a ratio of Gamma
+//     variates, see Sampler<BETA> in samplers.h.
 //
 
 float Distribution::BetaDistribution(void) {
-   static float pow1, pow2, sum, num1, num2;
-
-   while((num1 = myrand()) == 0.0) /* set int1 to be nonzero */ ;
-   while((num2 = myrand()) == 0.0) /* set int2 to be nonzero */ ;
-
-   pow1 = pow(int1, beta_inv_a);
-   pow2 = pow(int2, beta_inv_b);
-   sum  = pow1 + pow2;
-
-   if (sum > 1.0) {
-      return BetaDistribution();
-   } else {
-      return pow1/sum;
-   }
+   return Sampler<BETA, RandomSource>(*this)(*source);
 }
    
 
 
 //////////////////////////////
 //
-// Distribution::BilateralDistribution --
+// Distribution::BilateralDistribution -- Laplace distribution: an
+//     exponential deviate with a random sign.  The signs are taken one
+//     bit at a time from a cached 32-bit word.
 //
 
 float Distribution::BilateralDistribution(void) {
-   static double number;
-   number = 2.0 * myrand();
-   if (number == 0.0 || number == 2.0) {
-      return BilateralDistribution();
-   }
-   if (number <= 1.0) {
-      return log(number) / bilateral_lambda;
-   } else {
-      return -log((2.0-number) / bilateral_lambda);
+   if (signCount == 0) {
+      signBits = source->rand_int32();
+      signCount = 32;
    }
+   double number = zigguratExponential(*source) / bilateral_lambda;
+   uint32_t sign = signBits & 1;
+   signBits >>= 1;
+   signCount--;
+   return sign ? -number : number;
 }
    
 
 
 //////////////////////////////
 //
-// Distribution::CauchyDistribution --
+// Distribution::BinomialDistribution -- successes in binomial_shape.n
+//     trials: inversion for a mean below BINOMIAL_INVERSION_MEAN, BTRS
+//     above, see Sampler<BINOMIAL> in samplers.h.
 //
 
-#ifndef PI
-   #define PI (3.1415927)
-#endif
+float Distribution::BinomialDistribution(void) {
+   return Sampler<BINOMIAL, RandomSource>(*this)(*source);
+}
+
+
+
+//////////////////////////////
+//
+// Distribution::CauchyDistribution -- interpolated from cauchyTable,
+//     see quantiletable.h for the error bound.
+//
 
 float Distribution::CauchyDistribution(void) {
-  static double number;
-  while ((number = myrand()) == 0.5) {};
-  return cauchy_spread * tan(PI*number) + cauchy_mean;
+   return Sampler<CAUCHY, RandomSource>(*this)(*source);
+}
+
+
+
+//////////////////////////////
+//
+// Distribution::DiscreteDistribution -- an index drawn from discreteTable
+//     with one random word.
+//
+
+float Distribution::DiscreteDistribution(void) {
+   return Sampler<DISCRETE, RandomSource>(*this)(*source);
+}
+
+
+
+//////////////////////////////
+//
+// Distribution::EmpiricalDistribution -- the inverse CDF of the drawn
+//     density in empiricalTable.
+//
+
+float Distribution::EmpiricalDistribution(void) {
+   return Sampler<EMPIRICAL, RandomSource>(*this)(*source);
 }
 
 
 
 //////////////////////////////
 //
-// Distribution::ExponentialDistribution --
+// Distribution::ExponentialDistribution -- Ziggurat sampler, see
+//     ziggurat.h.
 //
 
 float Distribution::ExponentialDistribution(void) {
-   static double temp;
-   while ((temp = myrand()) == 0.0) {};
-   return -log(temp)/exponential_lambda;
+   return Sampler<EXPONENTIAL, RandomSource>(*this)(*source);
+}
+
+
+
+//////////////////////////////
+//
+// Distribution::GammaDistribution --
+//
+
+float Distribution::GammaDistribution(void) {
+   return Sampler<GAMMA, RandomSource>(*this)(*source);
 }
 
 
 
 //////////////////////////////
 //
-// Distribution::GaussianDistribution --
+// Distribution::GaussianDistribution -- Ziggurat sampler, see
+//     ziggurat.h.  One 32-bit draw per sample in about 99% of the
+//     cases, and the tails are not truncated.
 //
 
 float Distribution::GaussianDistribution(void) {
-   static int i;
-   static int n = 12;
-   static double scale = 1.0 / sqrt(n/12.0);
-   static double sum;
+   return Sampler<GAUSSIAN, RandomSource>(*this)(*source);
+}
+
+
 
-   sum = 0.0;
-   for (i=0; i<n; i++) {
-      sum += rand();
+//////////////////////////////
+//
+// Distribution::GaussianLegacyDistribution -- the original sum of 12
+//     uniform numbers, kept for patches which depend on its sound.  The
+//     output is limited to +/- 6 deviations.
+//
+
+float Distribution::GaussianLegacyDistribution(void) {
+   const int n = 12;
+   const double scale = 1.0 / sqrt(n/12.0);
+   double sum = 0.0;
+
+   for (int i=0; i<n; i++) {
+      sum += myrand();
    }
-   sum /= RAND_MAX;
    return gaussian_deviation * scale * (sum-n/2.0) + gaussian_mean;
 }
 
 
 
+//////////////////////////////
+//
+// Distribution::GeometricDistribution -- failures before the first
+//     success, floor(log(U) / log(1 - p)).
+//
+
+float Distribution::GeometricDistribution(void) {
+   return Sampler<GEOMETRIC, RandomSource>(*this)(*source);
+}
+
+
+
 //////////////////////////////
 //
 // Distribution::LinearDistribution --
 //
 
 float Distribution::LinearDistribution(void) {
-   static int int1, int2;
-   int1 = rand();
-   int2 = rand();
+   uint32_t int1 = source->rand_int32();
+   uint32_t int2 = source->rand_int32();
 
    if (int2 < int1) {
       int1 = int2;
    }
-   return (float)int1/RAND_MAX;
+   return (float)(int1 * (1.0 / 4294967296.0));
 }
    
 
 //////////////////////////////
 //
-// Distribution::TriangularDistribution --
+// Distribution::PoissonDistribution -- inversion for a mean below
+//     POISSON_INVERSION_MEAN, PTRS above, see Sampler<POISSON> in
+//     samplers.h.
 //
 
-float Distribution::TriangularDistribution(void) {
-   static float normed_value;
-   normed_value = myrand()+myrand();
-   static float output;
-
-   // scale each side of the triangle to the requested range:
-   if (normed_value < 1.0) {
-      output = (normed_value - 1.0) * triangular_diffl + triangular_max;
-   } else {
-      output = (normed_value - 1.0) * triangular_diffu + triangular_max;
-   }
-  
-   // normalize the sides of the triangle so that the probability
-   // densities matchup at the maximum:
-   if (triangular_diffl == triangular_diffu) {
-      return output;
-   } else if (output < triangular_max && triangular_diffl < triangular_diffu) {
-      if (myrand() < (float)triangular_diffl/triangular_diffu) {
-         return output;
-      } else {
-         return TriangularDistribution();
-      }
-   } else if (output > triangular_max && triangular_diffu < triangular_diffl) {
-      if (myrand() < (float)triangular_diffu/triangular_diffl) {
-         return output;
-      } else {
-         return TriangularDistribution();
-      }
-   }
+float Distribution::PoissonDistribution(void) {
+   return Sampler<POISSON, RandomSource>(*this)(*source);
+}
+
+
 
-   return output;
+//////////////////////////////
+//
+// Distribution::TriangularDistribution -- by the inverse CDF that the
+//     TRIANGULAR sampler of fill() uses, one random number per value.
+//
+
+float Distribution::TriangularDistribution(void) {
+   return (float)(triangular_max +
+         TriangularQuantile(myrand(), triangular_diffl, triangular_diffu));
 }
    
 
@@ -429,29 +766,381 @@ float Distribution::UniformDistribution(void) {
 
 //////////////////////////////
 //
-// Distribution::WeibullDistribution --
+// Distribution::WeibullDistribution -- interpolated from weibullTable,
+//     which is rebuilt by doWeibull() when the shape changes.
 //
 
 float Distribution::WeibullDistribution(void) {
-   static double number;   
+   return Sampler<WEIBULL, RandomSource>(*this)(*source);
+}
+
+
+
+//////////////////////////////
+//
+// Distribution::TruncatedDistribution -- inverts the cumulative
+//     distribution between the CDF values of the range set up by
+//     setTruncation(), so the cost per sample is constant.
+//
+
+float Distribution::TruncatedDistribution(void) {
+   double u = truncLow + myrand() * (truncHigh - truncLow);
+   double x;
+
+   switch (getType()) {
+      case UNIFORM:
+         x = u * uniform_range;
+         break;
+      case LINEAR:
+         x = -sqrt(u);
+         break;
+      case TRIANGULAR:
+         x = TriangularQuantile(u, triangular_diffl, triangular_diffu);
+         break;
+      case EXPONENTIAL:
+         x = -log1p(-u) / exponential_lambda;
+         break;
+      case BILATERAL:
+         x = LaplaceQuantile(u, bilateral_lambda);
+         break;
+      case GAUSSIAN:
+         x = NormalQuantile(u);
+         break;
+      case CAUCHY:
+         x = cauchyTable.at(u);
+         break;
+      case WEIBULL:
+         x = weibullTable.at(u);
+         break;
+      case EMPIRICAL:
+         x = empiricalTable.at(u);
+         break;
+      default:
+         return truncFallback;
+   }
+   return (float)clampValue(truncShift + truncSign * x, truncMin, truncMax);
+}
+
+
+
+//////////////////////////////
+//
+// Distribution::fillInverse -- block version of TruncatedDistribution().
+//
+
+void Distribution::fillInverse(float* out, int count) {
+   uint32_t words[FILL_BLOCK];
+   source->fill_u32(words, count);
+
+   const double low   = truncLow;
+   const double step  = (truncHigh - truncLow) * (1.0 / 4294967296.0);
+   const double shift = truncShift;
+   const double sign  = truncSign;
+   const float  min   = truncMin;
+   const float  max   = truncMax;
+   int i;
+
+   switch (getType()) {
+      case UNIFORM:
+         {
+            const double scale = sign * uniform_range;
+            for (i=0; i<count; i++) {
+               double u = low + words[i] * step;
+               out[i] = clampSample((float)(shift + scale * u), min, max);
+            }
+         }
+         break;
+      case LINEAR:
+         for (i=0; i<count; i++) {
+            double u = low + words[i] * step;
+            out[i] = clampSample((float)(shift - sign * sqrt(u)), min, max);
+         }
+         break;
+      case TRIANGULAR:
+         {
+            const double lower = triangular_diffl;
+            const double upper = triangular_diffu;
+            for (i=0; i<count; i++) {
+               double u = low + words[i] * step;
+               double x = TriangularQuantile(u, lower, upper);
+               out[i] = clampSample((float)(shift + sign * x), min, max);
+            }
+         }
+         break;
+      case EXPONENTIAL:
+         {
+            const double scale = -sign / exponential_lambda;
+            for (i=0; i<count; i++) {
+               double u = low + words[i] * step;
+               out[i] = clampSample((float)(shift + scale * log1p(-u)),
+                     min, max);
+            }
+         }
+         break;
+      case BILATERAL:
+         {
+            const double lambda = bilateral_lambda;
+            for (i=0; i<count; i++) {
+               double u = low + words[i] * step;
+               double x = LaplaceQuantile(u, lambda);
+               out[i] = clampSample((float)(shift + sign * x), min, max);
+            }
+         }
+         break;
+      case GAUSSIAN:
+         for (i=0; i<count; i++) {
+            double u = low + words[i] * step;
+            double x = NormalQuantile(u);
+            out[i] = clampSample((float)(shift + sign * x), min, max);
+         }
+         break;
+      case CAUCHY:
+         for (i=0; i<count; i++) {
+            double u = low + words[i] * step;
+            double x = cauchyTable.at(u);
+            out[i] = clampSample((float)(shift + sign * x), min, max);
+         }
+         break;
+      case WEIBULL:
+         for (i=0; i<count; i++) {
+            double u = low + words[i] * step;
+            double x = weibullTable.at(u);
+            out[i] = clampSample((float)(shift + sign * x), min, max);
+         }
+         break;
+      case EMPIRICAL:
+         for (i=0; i<count; i++) {
+            double u = low + words[i] * step;
+            double x = empiricalTable.at(u);
+            out[i] = clampSample((float)x, min, max);
+         }
+         break;
+      default:
+         for (i=0; i<count; i++) {
+            out[i] = TruncatedDistribution();
+         }
+         break;
+   }
+}
+
+
+
+//////////////////////////////
+//
+// Distribution::fillRejection -- unbounded samples from the kernel of the
+//     type and engine, then the few which fall outside the range are
+//     drawn again by value(min, max, attempts).  Counts and indices
+//     are left as they are.
+//
+
+void Distribution::fillRejection(float* out, int count, int attempts) {
+   int type = getType();
+   if (type < 0 || type >= NUM_TYPES) {
+      type = UNIFORM;      // as value() does
+   }
+   samplerTable.kernel[type][source->getEngine()](*this, *source, out, count);
+   if (!truncBounded) {
+      return;
+   }
 
-   number = myrand();
-   if (number == 0.0 || number == 1.0) {
-      return WeibullDistribution();
+   const float min = truncMin;
+   const float max = truncMax;
+   for (int i=0; i<count; i++) {
+      if (!(out[i] >= min && out[i] <= max)) {
+         out[i] = value(min, max, attempts);
+      }
+   }
+}
+
+
+
+//////////////////////////////
+//
+// Distribution::setTruncation -- CDF values of [min, max] for the current
+//     type and parameters.  Ranges in a right tail are mirrored into the
+//     left one, where the CDF keeps its precision.
+//
+
+void Distribution::setTruncation(float min, float max) {
+   double a = min;
+   double b = max;
+   double location = 0.0;     // where the mass is, if none is in range
+   double lambda;
+
+   truncMin     = min;
+   truncMax     = max;
+   truncValid   = true;
+   truncBounded = true;
+   truncInvert  = true;
+   truncReject  = false;
+   truncLow     = 0.0;
+   truncHigh    = 0.0;
+   truncShift   = 0.0;
+   truncSign    = 1.0;
+
+   switch (getType()) {
+      case UNIFORM:
+         location = uniform_low;
+         if (uniform_range > 0) {
+            truncLow  = clampValue((a - uniform_low) / uniform_range, 0, 1);
+            truncHigh = clampValue((b - uniform_low) / uniform_range, 0, 1);
+            truncShift = uniform_low;
+         }
+         break;
+
+      case LINEAR:
+         // in terms of the survival function (1 - x)^2
+         truncLow   = pow(1.0 - clampValue(b, 0, 1), 2);
+         truncHigh  = pow(1.0 - clampValue(a, 0, 1), 2);
+         truncShift = 1.0;
+         break;
+
+      case TRIANGULAR:
+         location = triangular_max;
+         if (triangular_diffl + triangular_diffu > 0) {
+            double lower = triangular_max - triangular_diffl;
+            double upper = triangular_max + triangular_diffu;
+            a = clampValue(a, lower, upper);
+            b = clampValue(b, lower, upper);
+            truncLow  = TriangularCdf(a - triangular_max, triangular_diffl,
+                                      triangular_diffu);
+            truncHigh = TriangularCdf(b - triangular_max, triangular_diffl,
+                                      triangular_diffu);
+            truncShift = triangular_max;
+         }
+         break;
+
+      case EXPONENTIAL:
+         // memoryless: the lower end plus an exponential cut at b - a
+         lambda = exponential_lambda;
+         if (lambda > 0 && b > 0) {
+            a = (a > 0) ? a : 0.0;
+            truncHigh  = -expm1(-lambda * (b - a));
+            truncShift = a;
+            truncReject = exp(-lambda * a) * truncHigh
+                  >= TRUNCATION_REJECT_MASS;
+         }
+         break;
+
+      case BILATERAL:
+         lambda = bilateral_lambda;
+         if (lambda > 0) {
+            if (a > 0) {
+               truncSign = -1.0;
+               a = -max;
+               b = -min;
+            }
+            truncLow  = LaplaceCdf(a, lambda);
+            truncHigh = LaplaceCdf(b, lambda);
+         }
+         truncReject = truncHigh - truncLow >= TRUNCATION_REJECT_MASS;
+         break;
+
+      case GAUSSIAN:
+         location = gaussian_mean;
+         if (gaussian_deviation > 0) {
+            a = (a - gaussian_mean) / gaussian_deviation;
+            b = (b - gaussian_mean) / gaussian_deviation;
+            truncShift = gaussian_mean;
+            truncSign  = gaussian_deviation;
+            if (a > 0) {
+               double t = a;
+               a = -b;
+               b = -t;
+               truncSign = -truncSign;
+            }
+            truncLow  = NormalCdf(a);
+            truncHigh = NormalCdf(b);
+         }
+         truncReject = truncHigh - truncLow >= TRUNCATION_REJECT_MASS;
+         break;
+
+      case CAUCHY:
+         location = cauchy_mean;
+         if (cauchy_spread > 0) {
+            a = (a - cauchy_mean) / cauchy_spread;
+            b = (b - cauchy_mean) / cauchy_spread;
+            truncShift = cauchy_mean;
+            truncSign  = cauchy_spread;
+            if (a > 0) {
+               double t = a;
+               a = -b;
+               b = -t;
+               truncSign = -truncSign;
+            }
+            truncLow  = CauchyCdf(a);
+            truncHigh = CauchyCdf(b);
+         }
+         truncReject = truncHigh - truncLow >= TRUNCATION_REJECT_MASS;
+         break;
+
+      case WEIBULL:
+         if (weibull_s != 0) {
+            double t = 1.0 / weibull_inv_t;
+            a /= weibull_s;
+            b /= weibull_s;
+            if (weibull_s < 0) {
+               double swap = a;
+               a = b;
+               b = swap;
+            }
+            truncLow  = (a > 0) ? -expm1(-pow(a, t)) : 0.0;
+            truncHigh = (b > 0) ? -expm1(-pow(b, t)) : 0.0;
+            truncSign = weibull_s;
+         }
+         truncReject = truncHigh - truncLow >= TRUNCATION_REJECT_MASS;
+         break;
+
+      case EMPIRICAL:
+         location = empiricalTable.at(0.5);
+         truncLow  = empiricalTable.cdf(a);
+         truncHigh = empiricalTable.cdf(b);
+         truncReject = truncHigh - truncLow >= TRUNCATION_REJECT_MASS;
+         break;
+
+      case POISSON:
+      case BINOMIAL:
+      case GEOMETRIC:
+      case DISCRETE:
+         truncBounded = false;
+         truncInvert = false;
+         break;
+
+      default:
+         truncInvert = false;
+         break;
    }
 
-   return weibull_s * pow(log(1.0/(1.0-number)), weibull_inv_t);
+   truncFallback = (float)clampValue(location, min, max);
+}
+
+
+
+//////////////////////////////
+//
+// Distribution::setGammaShape -- precompute the gammaVariate() constants.
+//
+
+void Distribution::setGammaShape(GammaShape& shape, double value) {
+   shape.boost = 0.0;
+   if (value < 1.0) {
+      shape.boost = 1.0 / value;
+      value += 1.0;
+   }
+   shape.d = value - 1.0 / 3.0;
+   shape.c = 1.0 / sqrt(9.0 * shape.d);
 }
 
 
 
 //////////////////////////////
 //
-// Distribution::myrand -- returns a number between 0 and 1.
+// Distribution::myrand -- returns a number in [0, 1) with 32 bits of
+//     resolution, from the engine of the owning module.
 //
 
-float Distribution::myrand(void) {
-   return (float)rand()/RAND_MAX;
+double Distribution::myrand(void) {
+   return source->rand_int32() * (1.0 / 4294967296.0);
 }
 
 
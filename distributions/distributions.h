@@ -11,6 +11,11 @@
 #ifndef DISTRIBUTION_H_INCLUDED
 #define DISTRIBUTION_H_INCLUDED
 
+#include "randomsource.h"
+#include "quantiletable.h"
+#include "aliastable.h"
+#include "empiricaltable.h"
+
 #define UNIFORM      (0)
 #define LINEAR       (1)
 #define TRIANGULAR   (2)
@@ -21,26 +26,100 @@
 #define BETA         (7)
 #define WEIBULL      (8)
 #define POISSON      (9)
+#define GAUSSIAN_LEGACY (10)
+#define GAMMA        (11)
+#define BINOMIAL     (12)
+#define GEOMETRIC    (13)
+#define DISCRETE     (14)
+#define EMPIRICAL    (15)
+
+#define NUM_TYPES    (16)
+
+// below these means Poisson and Binomial are sampled by inversion, whose
+// cost grows with the mean, above them by transformed rejection
+#define POISSON_INVERSION_MEAN  (10.0)
+#define BINOMIAL_INVERSION_MEAN (10.0)
+
+// parameters outside their range are clamped into it rather than
+// rejected: shapes and rates to at least SHAPE_MIN, probabilities that
+// must be positive to at least PROBABILITY_MIN
+#define SHAPE_MIN              (1.0e-3)
+#define PROBABILITY_MIN        (1.0e-6)
 
+// value(min, max, ...) tries at most this many unbounded samples before
+// inverting the cumulative distribution, when [min, max] holds at least
+// TRUNCATION_REJECT_MASS of the probability.
+#define TRUNCATION_ATTEMPTS    (4)
+#define TRUNCATION_REJECT_MASS (0.5)
+
+// fill() works on blocks of this many samples, and gives the types
+// without an invertible CDF this many attempts per sample
+#define FILL_BLOCK             (256)
+#define FILL_ATTEMPTS          (128)
+
+
+// Marsaglia-Tsang constants for one gamma shape
+struct GammaShape {
+   double d, c;            // shape - 1/3 and 1/sqrt(9 d), of the boosted shape
+   double boost;           // 1/shape when shape < 1 is boosted by one, else 0
+};
+
+// Hoermann's PTRS constants for one Poisson mean
+struct PoissonShape {
+   double mean, logMean;
+   double a, b;            // of the transformed hat, b = 0.931 + 2.53 sqrt(mean)
+   double logInvAlpha;     // log of the hat normalisation
+   double vr;              // acceptance without a log() below this
+};
+
+// Hoermann's BTRS constants for one number of trials and p <= 1/2
+struct BinomialShape {
+   int    n;
+   double p, q;
+   bool   flip;            // p was > 1/2: the count of failures is sampled
+   double a, b, c;         // of the transformed hat
+   double alpha, vr;
+   double m, h;            // mode and log(m! (n - m)!)
+   double logRatio;        // log(p / q)
+};
+
+
+template <int Type, class Engine> class Sampler;
+template <int Type, class Engine> struct SamplerBlock;
 
 class Distribution {
+   template <int Type, class Engine> friend class Sampler;
+   template <int Type, class Engine> friend struct SamplerBlock;
+
    public:
-                    Distribution  (void);
-                    Distribution  (int aSeed);
+                    Distribution  (RandomSource& aSource);
                    ~Distribution  ();
 
       void          doBeta        (void);
       void          doBeta        (float Avalue, float Bvalue);
       void          doBilateral   (void);
       void          doBilateral   (float aLambda);
+      void          doBinomial    (void);
+      void          doBinomial    (int aTrials, float aProbability);
       void          doCauchy      (void);
       void          doCauchy      (float aSpread, float aMean);
+      void          doGamma       (void);
+      void          doGamma       (float aShape, float aScale);
+      void          doDiscrete    (void);
+      void          doDiscrete    (const float* weights, int n);
+      void          doEmpirical   (void);
+      void          doEmpirical   (const float* density, int n);
       void          doExponential (void);
       void          doExponential (float aLambda);
       void          doGaussian    (void);
       void          doGaussian    (float aDeviation, float aMean);
+      void          doGaussianLegacy (void);
+      void          doGaussianLegacy (float aDeviation, float aMean);
+      void          doGeometric   (void);
+      void          doGeometric   (float aProbability);
       void          doLinear      (void);
       void          doPoisson     (void);
+      void          doPoisson     (float aMean);
       void          doTriangular  (void);
       void          doTriangular  (float alowerLimit, float aMax,
                                    float anUpperLimit);
@@ -48,28 +127,56 @@ class Distribution {
       void          doUniform   (float aLowerLimit, float anUpperLimit);
       void          doWeibull     (void);
       void          doWeibull     (float t, float s);
+      void          fill          (float* out, int n, float min,
+                                   float max);
 
       int           getType       (void);
       void          seed          (int seed);
+      void          setSource     (RandomSource& aSource);
+      void          dropBits      (void);
       int           setType       (int newDistributionType);
       float     value         (void);
       float     value         (float min, float max, 
                                      int numAttempts);
 
    protected:
+      RandomSource* source;             // per instance engine, not owned
       int           seedValue;
       int           distributionType;
-      int           int1, int2;         // for temporary storage space
+      float     beta_a, beta_b;     // parameters for Beta distribution
       float     beta_inv_a;         // parameters for Beta distribution
       float     beta_inv_b;         // parameters for Beta distribution
+      GammaShape beta_gamma_a;      // Beta as a ratio of Gamma variates
+      GammaShape beta_gamma_b;
+      GammaShape gamma_shape;       // parameter for Gamma dist.
+      float     gamma_scale;        // parameter for Gamma dist.
       float     exponential_lambda; // parameter for Exponential dist.
       float     bilateral_lambda;   // parameter for Bilateral dist.
+      uint32_t  signBits;           // unused random bits for the sign
+      int       signCount;          // of the Bilateral distribution
       float     gaussian_deviation; // parameter for Gaussian dist.
       float     gaussian_mean;      // parameter for Gaussian dist.
       float     cauchy_spread;      // parameter for Cauchy dist.
       float     cauchy_mean;        // parameter for Cauchy dist.
       float     weibull_inv_t;      // parameter for Weibull dist.
       float     weibull_s;          // parameter for Weibull dist.
+      PoissonShape poisson_shape;   // parameter for Poisson dist.
+      BinomialShape binomial_shape; // parameter for Binomial dist.
+      float     geometric_p;        // parameter for Geometric dist.
+      double    geometric_log_q;    // parameter for Geometric dist.
+      AliasTable discreteTable;     // weights of the Discrete dist.
+      EmpiricalTable empiricalTable;// density of the Empirical dist.
+      float     truncMin, truncMax; // range of the truncation constants
+      bool      truncValid;         // cleared by setType()
+      bool      truncBounded;       // false for counts and indices
+      bool      truncInvert;        // type has an invertible CDF
+      bool      truncReject;        // try value() before inverting
+      double    truncLow, truncHigh;// CDF at the ends of the range
+      double    truncShift;         // applied to the inverse CDF as
+      double    truncSign;          //    shift + sign * x
+      float     truncFallback;      // when the range holds no probability
+      QuantileTable cauchyTable;    // standard Cauchy quantiles
+      QuantileTable weibullTable;   // Weibull quantiles for scale 1
       float     triangular_diffu;   // parameter for Triangular dist.
       float     triangular_diffl;   // parameter for Triangular dist.
       float     triangular_max;     // parameter for Triangular dist.
@@ -79,15 +186,28 @@ class Distribution {
       // private functions:
       float     BetaDistribution        (void);
       float     BilateralDistribution   (void);
+      float     BinomialDistribution    (void);
       float     CauchyDistribution      (void);
+      float     DiscreteDistribution    (void);
+      float     EmpiricalDistribution   (void);
       float     ExponentialDistribution (void);
+      float     GammaDistribution       (void);
       float     GaussianDistribution    (void);
+      float     GaussianLegacyDistribution (void);
+      float     GeometricDistribution   (void);
       float     LinearDistribution      (void);
+      float     PoissonDistribution     (void);
       float     TriangularDistribution  (void);
       float     UniformDistribution     (void);
       float     WeibullDistribution     (void);
+      float     TruncatedDistribution   (void);
+      void      fillInverse             (float* out, int count);
+      void      fillRejection           (float* out, int count,
+                                         int attempts);
+      void      setTruncation           (float min, float max);
 
-      float     myrand                  (void);
+      void      setGammaShape           (GammaShape& shape, double value);
+      double    myrand                  (void);
 };
 
 
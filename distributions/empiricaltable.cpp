@@ -0,0 +1,113 @@
+//
+// Sampler for a drawn distribution, see empiricaltable.h for information.
+//
+
+#include "empiricaltable.h"
+
+
+//////////////////////////////
+//
+// EmpiricalTable::EmpiricalTable -- starts flat.
+//
+
+EmpiricalTable::EmpiricalTable() {
+   capacity = 0;
+   height = 0;
+   cumulative = 0;
+   guide = 0;
+   build(0, 0);
+}
+
+
+
+//////////////////////////////
+//
+// EmpiricalTable::~EmpiricalTable --
+//
+
+EmpiricalTable::~EmpiricalTable() {
+   delete [] height;
+   delete [] cumulative;
+   delete [] guide;
+}
+
+
+
+//////////////////////////////
+//
+// EmpiricalTable::build -- the trapezoid areas of the segments summed
+//     into the CDF, and the guide table from one pass over both.
+//
+
+void EmpiricalTable::build(const float* density, int n) {
+   bool flat = n < 2;
+   if (flat) {
+      n = 2;
+   }
+   if ((uint32_t)n > capacity) {
+      delete [] height;
+      delete [] cumulative;
+      delete [] guide;
+      capacity = n;
+      height = new double[capacity];
+      cumulative = new double[capacity];
+      guide = new uint32_t[capacity];
+   }
+   segments = n - 1;
+
+   double sum = 0.0;
+   for (int i=0; i<n; i++) {
+      double y = flat ? 1.0 : density[i];
+      height[i] = (y > 0.0) ? y : 0.0;      // also maps nan to 0
+      sum += height[i];
+   }
+   if (!(sum > 0.0) || sum > 1e300) {
+      for (int i=0; i<n; i++) {
+         height[i] = 1.0;
+      }
+   }
+
+   cumulative[0] = 0.0;
+   for (uint32_t i=0; i<segments; i++) {
+      cumulative[i + 1] = cumulative[i]
+            + 0.5 * (height[i] + height[i + 1]) / segments;
+   }
+   total = cumulative[segments];
+   for (uint32_t i=1; i<segments; i++) {
+      cumulative[i] /= total;
+   }
+   cumulative[segments] = 1.0;
+
+   uint32_t i = 0;
+   for (uint32_t g=0; g<segments; g++) {
+      double u = (double)g / segments;
+      while (i < segments - 1 && cumulative[i + 1] <= u) {
+         i++;
+      }
+      guide[g] = i;
+   }
+}
+
+
+
+//////////////////////////////
+//
+// EmpiricalTable::cdf -- the area under the density up to x.
+//
+
+double EmpiricalTable::cdf(double x) const {
+   if (!(x > 0.0)) {
+      return 0.0;
+   }
+   if (x >= 1.0) {
+      return 1.0;
+   }
+   double position = x * segments;
+   uint32_t i = (uint32_t)position;
+   if (i >= segments) {
+      i = segments - 1;
+   }
+   double t = (position - i) / segments;
+   double slope = (height[i + 1] - height[i]) * segments;
+   return cumulative[i] + (height[i] * t + 0.5 * slope * t * t) / total;
+}
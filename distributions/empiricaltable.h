@@ -0,0 +1,72 @@
+//
+// Sampler for a continuous distribution drawn as an array.
+//
+// build() reads n density values y[0] ... y[n - 1] at the evenly spaced
+// points x = i / (n - 1) of [0, 1], joined by straight lines, and sums the
+// cumulative distribution at every point. A uniform number u is located
+// among those sums with a guide table of n entries, which points at the
+// segment holding each of n equal slices of probability, so on average one
+// step of linear search is left. Within the segment the CDF is quadratic
+// and is inverted exactly, with one square root.
+//
+// Negative and nan values count as 0; if all are 0, or there are fewer than
+// two, the density is flat. The arrays only grow, so rebuilding with the same or
+// fewer values does not allocate.
+//
+
+#ifndef EMPIRICALTABLE_H_INCLUDED
+#define EMPIRICALTABLE_H_INCLUDED
+
+#include <stdint.h>
+#include <math.h>
+
+
+class EmpiricalTable {
+   public:
+                    EmpiricalTable ();
+                   ~EmpiricalTable ();
+
+      void          build         (const float* density, int n);
+
+      // cumulative distribution at x, for truncated ranges
+      double        cdf           (double x) const;
+
+      // sample for a 32-bit random word
+      double        sample        (uint32_t word) const {
+         return at((word + 0.5) * (1.0 / 4294967296.0));
+      }
+
+      // sample for a uniform number u in [0, 1]
+      double        at            (double u) const {
+         uint32_t g = (uint32_t)(u * segments);
+         uint32_t i = guide[g < segments ? g : segments - 1];
+         while (i < segments - 1 && cumulative[i + 1] <= u) {
+            i++;
+         }
+         // solve y t + slope t^2 / 2 = mass in the stable form
+         double mass = (u - cumulative[i]) * total;
+         double y = height[i];
+         double slope = (height[i + 1] - y) * segments;
+         double root = y * y + 2.0 * slope * mass;
+         double t = 2.0 * mass / (y + sqrt(root > 0.0 ? root : 0.0));
+         if (!(t >= 0.0)) {            // 0 / 0 on a segment without mass
+            t = 0.0;
+         }
+         return (i + (t * segments < 1.0 ? t * segments : 1.0)) / segments;
+      }
+
+   protected:
+      uint32_t      segments;       // n - 1, at least 1
+      uint32_t      capacity;       // allocated points
+      double        total;          // area under the density
+      double*       height;         // density at the segments + 1 points
+      double*       cumulative;     // CDF there
+      uint32_t*     guide;          // first segment reaching each slice
+
+   private:
+      EmpiricalTable (const EmpiricalTable&);
+      void          operator=     (const EmpiricalTable&);
+};
+
+
+#endif  /* EMPIRICALTABLE_H_INCLUDED */
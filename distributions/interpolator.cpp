@@ -0,0 +1,179 @@
+//
+// Held and interpolated random values, see interpolator.h for information.
+//
+
+#include "interpolator.h"
+#include <float.h>
+
+
+//////////////////////////////
+//
+// Interpolator::Interpolator -- room for aCapacity channels, one sample
+//     per segment and step shape until told otherwise.
+//
+
+Interpolator::Interpolator(int aCapacity) {
+   capacity = aCapacity > 0 ? aCapacity : 1;
+   points = new float[4 * capacity];
+   shape = INTERP_STEP;
+   increment = 1.0;
+   low = -FLT_MAX;
+   high = FLT_MAX;
+   restart();
+}
+
+
+
+//////////////////////////////
+//
+// Interpolator::~Interpolator --
+//
+
+Interpolator::~Interpolator() {
+   delete [] points;
+}
+
+
+
+//////////////////////////////
+//
+// Interpolator::setShape -- one of INTERP_STEP, INTERP_LINEAR,
+//     INTERP_COSINE or INTERP_CUBIC; anything else steps.
+//
+
+void Interpolator::setShape(int aShape) {
+   shape = aShape;
+}
+
+
+
+//////////////////////////////
+//
+// Interpolator::setIncrement -- segments per sample, the frequency over
+//     the sample rate.  Limited to one new value per sample.
+//
+
+void Interpolator::setIncrement(double anIncrement) {
+   if (!(anIncrement > 0.0)) {
+      anIncrement = 1e-9;
+   } else if (anIncrement > 1.0) {
+      anIncrement = 1.0;
+   }
+   increment = anIncrement;
+}
+
+
+
+//////////////////////////////
+//
+// Interpolator::setLimits -- the range the drawn values come from, which
+//     the cubic shape is clamped to.  Unlimited to start with.
+//
+
+void Interpolator::setLimits(float aLow, float aHigh) {
+   low = aLow;
+   high = aHigh;
+}
+
+
+
+//////////////////////////////
+//
+// Interpolator::restart -- starts a segment and draws every value again
+//     at the next fill().
+//
+
+void Interpolator::restart(void) {
+   ready = 0;
+   phase = 0.0;
+}
+
+
+
+//////////////////////////////
+//
+// cosineWeight -- (1 - cos(pi t)) / 2 for t in [0, 1], as 1/2 + sin(x) / 2
+//     with x = pi (t - 1/2) in [-pi/2, pi/2], where the Taylor series to
+//     x^11 is within 6e-8 of sin(x).  Polynomial only, so loops over it
+//     vectorise.
+//
+
+static inline float cosineWeight(float t) {
+   float x = 3.14159265f * (t - 0.5f);
+   float x2 = x * x;
+   float s = -2.50521084e-8f;
+   s = s * x2 + 2.75573192e-6f;
+   s = s * x2 - 1.98412698e-4f;
+   s = s * x2 + 8.33333333e-3f;
+   s = s * x2 - 1.66666667e-1f;
+   s = s * x2 + 1.0f;
+   return 0.5f + 0.5f * x * s;
+}
+
+
+
+//////////////////////////////
+//
+// Interpolator::render -- count frames of the current segment from the
+//     current phase.
+//
+
+void Interpolator::render(float* out, int count, int channels) {
+   int i;
+   const float start = (float)phase;
+   const float step = (float)increment;
+   for (i=0; i<count; i++) {
+      float t = start + i * step;
+      weight[i] = t < 1.0f ? t : 1.0f;
+   }
+   if (shape == INTERP_COSINE) {
+      for (i=0; i<count; i++) {
+         weight[i] = cosineWeight(weight[i]);
+      }
+   }
+
+   for (int c=0; c<channels; c++) {
+      const float* p = points + 4 * c;
+      float* dest = (channels == 1) ? out : block;
+
+      switch (shape) {
+         case INTERP_LINEAR:
+         case INTERP_COSINE:
+            {
+               const float from = p[1];
+               const float span = p[2] - p[1];
+               for (i=0; i<count; i++) {
+                  dest[i] = from + span * weight[i];
+               }
+            }
+            break;
+         case INTERP_CUBIC:
+            {
+               // Catmull-Rom as a polynomial in t
+               const float k0 = p[1];
+               const float k1 = 0.5f * (p[2] - p[0]);
+               const float k2 = p[0] - 2.5f * p[1] + 2.0f * p[2] - 0.5f * p[3];
+               const float k3 = 0.5f * (p[3] - p[0]) + 1.5f * (p[1] - p[2]);
+               for (i=0; i<count; i++) {
+                  float t = weight[i];
+                  float v = ((k3 * t + k2) * t + k1) * t + k0;
+                  v = v < low ? low : v;
+                  dest[i] = v > high ? high : v;
+               }
+            }
+            break;
+         default:
+            for (i=0; i<count; i++) {
+               dest[i] = p[2];
+            }
+            break;
+      }
+
+      if (channels > 1) {
+         float* channel = out + c;
+         for (i=0; i<count; i++) {
+            channel[i * channels] = block[i];
+         }
+      }
+   }
+}
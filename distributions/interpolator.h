@@ -0,0 +1,125 @@
+//
+// Random values held or interpolated over segments of a given length, for
+// random LFOs.
+//
+// Each channel keeps the last four values drawn, p0 to p3, and the output
+// runs from p1 to p2 over one segment of 1 / increment samples:
+//
+//    step      p2 for the whole segment
+//    linear    a straight line from p1 to p2
+//    cosine    half a cosine from p1 to p2, flat at both ends
+//    cubic     the Catmull-Rom spline through p0 to p3, clamped to the
+//              limits given with setLimits(), since the curve can
+//              overshoot the values it passes through
+//
+// At the end of a segment the values move down one place and one new value
+// is drawn for p3, so a channel costs one draw per segment whatever the
+// shape, and nothing is drawn between segments. The phase runs on across
+// calls, and changing the increment or the shape takes effect at once.
+//
+// fill() calls draw(c) for a new value of channel c. The weights of a run
+// of frames are worked out once for all channels, and each channel is
+// rendered as a contiguous block before it is interleaved, so the inner
+// loops vectorise.
+//
+
+#ifndef INTERPOLATOR_H_INCLUDED
+#define INTERPOLATOR_H_INCLUDED
+
+#define INTERP_STEP       (0)
+#define INTERP_LINEAR     (1)
+#define INTERP_COSINE     (2)
+#define INTERP_CUBIC      (3)
+
+#define INTERP_BLOCK      (256)      // frames rendered at a time
+
+
+class Interpolator {
+   public:
+                    Interpolator  (int aCapacity);
+                   ~Interpolator  ();
+
+      void          setShape      (int aShape);
+      void          setIncrement  (double anIncrement);
+      void          setLimits     (float aLow, float aHigh);
+      void          restart       (void);
+
+      // frames frames of channels channels, interleaved by frame
+      template <class Draw>
+      void          fill          (float* out, int frames, int channels,
+                                   Draw& draw);
+
+   protected:
+      int           capacity;       // channels the points are allocated for
+      int           ready;          // channels with four values drawn
+      int           shape;
+      double        increment;      // segments per sample, (0, 1]
+      double        phase;          // position in the segment, [0, 1)
+      float         low, high;      // range of the drawn values
+      float*        points;         // p0 to p3 of each channel
+      float         weight[INTERP_BLOCK];  // per frame of a run
+      float         block[INTERP_BLOCK];   // one channel of a run
+
+      void          render        (float* out, int count, int channels);
+
+   private:
+      Interpolator  (const Interpolator&);
+      void          operator=     (const Interpolator&);
+};
+
+
+
+//////////////////////////////
+//
+// Interpolator::fill -- runs of frames up to the next segment end, or at
+//     most INTERP_BLOCK; new values are drawn at the start of a segment.
+//
+
+template <class Draw>
+void Interpolator::fill(float* out, int frames, int channels, Draw& draw) {
+   if (channels > capacity) {
+      channels = capacity;
+   }
+   for (; ready < channels; ready++) {
+      for (int k=0; k<4; k++) {
+         points[4 * ready + k] = draw(ready);
+      }
+   }
+
+   while (frames > 0) {
+      if (phase >= 1.0) {
+         phase -= 1.0;
+         if (phase >= 1.0) {
+            phase = 0.0;
+         }
+         for (int c=0; c<channels; c++) {
+            float* p = points + 4 * c;
+            p[0] = p[1];
+            p[1] = p[2];
+            p[2] = p[3];
+            p[3] = draw(c);
+         }
+      }
+
+      // frames which start before the segment ends
+      double left = (1.0 - phase) / increment;
+      int count = frames < INTERP_BLOCK ? frames : INTERP_BLOCK;
+      if (left < count) {
+         count = (int)left;
+         if (count < left) {
+            count++;
+         }
+         if (count < 1) {
+            count = 1;
+         }
+      }
+
+      render(out, count, channels);
+      phase += count * increment;
+      out += count * channels;
+      frames -= count;
+   }
+}
+
+
+#endif  /* INTERPOLATOR_H_INCLUDED */
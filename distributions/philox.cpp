@@ -0,0 +1,104 @@
+// philox.cpp, see include file philox.h for information
+
+#include "philox.h"
+#include "sfmtrand.h" // for SFMT_SSE2
+#ifdef SFMT_SSE2
+  #include <emmintrin.h>
+#endif
+
+// Philox4x32 multipliers and Weyl key increments
+static const uint32_t philox_m0 = 0xD2511F53U, philox_m1 = 0xCD9E8D57U;
+static const uint32_t philox_w0 = 0x9E3779B9U, philox_w1 = 0xBB67AE85U;
+static const int philox_rounds = 10;
+
+void Philox4x32::generate(uint64_t block, uint32_t* out) const {
+  uint32_t c0 = static_cast<uint32_t>(block), c1 = static_cast<uint32_t>(block >> 32);
+  uint32_t c2 = static_cast<uint32_t>(stream), c3 = static_cast<uint32_t>(stream >> 32);
+  uint32_t k0 = key[0], k1 = key[1];
+  for (int r = 0; r < philox_rounds; ++r) {
+    if (r) { k0 += philox_w0; k1 += philox_w1; }
+    uint64_t p0 = static_cast<uint64_t>(philox_m0) * c0;
+    uint64_t p1 = static_cast<uint64_t>(philox_m1) * c2;
+    uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+    uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+    c1 = static_cast<uint32_t>(p1);
+    c3 = static_cast<uint32_t>(p0);
+    c0 = n0; c2 = n2;
+  }
+  out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+#ifdef SFMT_SSE2
+
+// high and low halves of the four 32 x 32 bit products a * m
+static inline void philox_mulhilo(__m128i a, __m128i m, __m128i& hi, __m128i& lo) {
+  __m128i even = _mm_mul_epu32(a, m); // lanes 0 and 2, 64 bit each
+  __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), m); // lanes 1 and 3
+  lo = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(3, 1, 2, 0)),
+    _mm_shuffle_epi32(odd, _MM_SHUFFLE(3, 1, 2, 0)));
+  hi = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(2, 0, 3, 1)),
+    _mm_shuffle_epi32(odd, _MM_SHUFFLE(2, 0, 3, 1)));
+}
+
+void Philox4x32::generate_blocks(uint64_t block, int blocks, uint32_t* out) const {
+  const __m128i m0 = _mm_set1_epi32(static_cast<int>(philox_m0));
+  const __m128i m1 = _mm_set1_epi32(static_cast<int>(philox_m1));
+  int b = 0;
+// four blocks per iteration, word k of the four blocks in one register;
+// the vector path needs the low counter word not to wrap inside the group
+  for (; b + 4 <= blocks && static_cast<uint32_t>(block + b) <= 0xFFFFFFFCU; b += 4) {
+    uint64_t first = block + b;
+    __m128i c0 = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(first)), _mm_set_epi32(3, 2, 1, 0));
+    __m128i c1 = _mm_set1_epi32(static_cast<int>(first >> 32));
+    __m128i c2 = _mm_set1_epi32(static_cast<int>(stream));
+    __m128i c3 = _mm_set1_epi32(static_cast<int>(stream >> 32));
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int r = 0; r < philox_rounds; ++r) {
+      if (r) { k0 += philox_w0; k1 += philox_w1; }
+      __m128i hi0, lo0, hi1, lo1;
+      philox_mulhilo(c0, m0, hi0, lo0);
+      philox_mulhilo(c2, m1, hi1, lo1);
+      c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32(static_cast<int>(k0)));
+      c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32(static_cast<int>(k1)));
+      c1 = lo1;
+      c3 = lo0;
+    }
+    // transpose back to four consecutive blocks
+    __m128i t0 = _mm_unpacklo_epi32(c0, c1), t1 = _mm_unpacklo_epi32(c2, c3);
+    __m128i t2 = _mm_unpackhi_epi32(c0, c1), t3 = _mm_unpackhi_epi32(c2, c3);
+    __m128i* o = reinterpret_cast<__m128i*>(out + 4 * b);
+    _mm_storeu_si128(o, _mm_unpacklo_epi64(t0, t1));
+    _mm_storeu_si128(o + 1, _mm_unpackhi_epi64(t0, t1));
+    _mm_storeu_si128(o + 2, _mm_unpacklo_epi64(t2, t3));
+    _mm_storeu_si128(o + 3, _mm_unpackhi_epi64(t2, t3));
+  }
+  for (; b < blocks; ++b) generate(block + b, out + 4 * b);
+}
+
+#else
+
+void Philox4x32::generate_blocks(uint64_t block, int blocks, uint32_t* out) const {
+  for (int b = 0; b < blocks; ++b) generate(block + b, out + 4 * b);
+}
+
+#endif // SFMT_SSE2
+
+void Philox4x32::fill_u32(uint32_t* out, int count) { // bulk 32 bit integers
+  while (count > 0 && (pos & 3)) { *out++ = rand_int32(); --count; } // finish the current block
+  int blocks = count >> 2;
+  generate_blocks(pos >> 2, blocks, out);
+  pos += 4 * static_cast<uint64_t>(blocks);
+  out += 4 * blocks; count -= 4 * blocks;
+  while (count > 0) { *out++ = rand_int32(); --count; }
+}
+
+void Philox4x32::fill(float* out, int count) { // bulk floats in [0, 1)
+  uint32_t words[64];
+  while (count > 0) {
+    int run = count < 64 ? count : 64;
+    fill_u32(words, run);
+    for (int i = 0; i < run; ++i) // upper 24 bits, exact and branch free
+      out[i] = static_cast<float>(static_cast<int32_t>(words[i] >> 8)) * (1.f / 16777216.f);
+    out += run; count -= run;
+  }
+}
@@ -0,0 +1,55 @@
+// philox.h
+// Philox4x32-10 counter based random number engine, from John K. Salmon,
+// Mark A. Moraes, Ron O. Dror and David E. Shaw, "Parallel random numbers:
+// as easy as 1, 2, 3" (SC11), http://www.deshawresearch.com/resources_random123.html
+//
+// The output is a pure function of (key, counter): block b of a stream is
+// Philox(key = seed, counter = {b, stream}), four 32 bit words per block.
+// Any position of any stream can therefore be computed directly, seek() is
+// O(1), and blocks do not depend on each other, so fill_u32() generates four
+// blocks per iteration with SSE2 (scalar fallback with the same output).
+// The engine follows the interface described in engines.h.
+
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <stdint.h>
+#include "engines.h"
+
+class Philox4x32 : public EngineBase<Philox4x32> {
+public:
+  Philox4x32() { seed(5489UL); }
+  Philox4x32(unsigned long s) { seed(s); }
+  void seed(unsigned long s) { seed64(s); }
+  void seed(const unsigned long* array, int size) { seed64(fold_seed(array, size)); }
+  void seed64(uint64_t s) { // new key, back to the start of stream 0
+    key[0] = static_cast<uint32_t>(s); key[1] = static_cast<uint32_t>(s >> 32);
+    stream = 0; seek(0);
+  }
+  void setStream(uint64_t s) { stream = s; seek(0); } // select an independent stream
+  uint64_t getStream() const { return stream; }
+  void seek(uint64_t position) { pos = position; cached = ~0ULL; } // in 32 bit numbers
+  uint64_t tell() const { return pos; }
+// the number at any position of the current stream, without moving
+  uint32_t at(uint64_t position) const {
+    uint32_t block[4];
+    generate(position >> 2, block);
+    return block[position & 3];
+  }
+  uint32_t rand_int32() {
+    if ((pos >> 2) != cached) { cached = pos >> 2; generate(cached, buffer); }
+    return buffer[pos++ & 3];
+  }
+  void fill_u32(uint32_t* out, int count); // bulk 32 bit integers
+  void fill(float* out, int count); // bulk floats in [0, 1)
+private:
+  void generate(uint64_t block, uint32_t* out) const; // one block of four numbers
+  void generate_blocks(uint64_t block, int blocks, uint32_t* out) const; // out[4 * blocks]
+  uint32_t key[2];
+  uint64_t stream;
+  uint64_t pos; // position in the stream, in 32 bit numbers
+  uint64_t cached; // block held in buffer
+  uint32_t buffer[4];
+};
+
+#endif // PHILOX_H
@@ -0,0 +1,102 @@
+//
+// Inverse-CDF table sampler, see quantiletable.h for information.
+//
+
+#include "quantiletable.h"
+#include <math.h>
+
+
+//////////////////////////////
+//
+// QuantileTable::QuantileTable -- an empty table samples nothing until
+//     build() is called.
+//
+
+QuantileTable::QuantileTable() {
+   quantile = 0;
+   shape = 0.0;
+   low = 0;
+   span = 0;
+   maxError = 0.0;
+   knot = 0;
+}
+
+
+
+//////////////////////////////
+//
+// QuantileTable::~QuantileTable --
+//
+
+QuantileTable::~QuantileTable() {
+   delete [] knot;
+}
+
+
+
+//////////////////////////////
+//
+// QuantileTable::build -- tabulate aQuantile and measure the error of
+//     every segment at its midpoint.  The interpolated segments are the
+//     widest run around the median that meets QUANTILE_TOLERANCE.
+//
+
+void QuantileTable::build(Quantile aQuantile, double aShape) {
+   const int n = QUANTILE_SEGMENTS;
+   const int half = n / 2;
+   quantile = aQuantile;
+   shape = aShape;
+   if (knot == 0) {
+      knot = new float[n + 1];
+   }
+
+   // the end points are usually poles, and never interpolated
+   knot[0] = 0.0f;
+   knot[n] = 0.0f;
+   for (int i = 1; i < n; i++) {
+      knot[i] = (float)quantile((double)i / n, shape);
+   }
+
+   int first = 1;              // segments [first, last) meet the tolerance
+   int last = n - 1;
+   double error[QUANTILE_SEGMENTS];
+   for (int i = 1; i < n - 1; i++) {
+      double exact = quantile((i + 0.5) / n, shape);
+      double table = 0.5 * ((double)knot[i] + (double)knot[i + 1]);
+      double scale = fabs(exact) > 1.0 ? fabs(exact) : 1.0;
+      error[i] = fabs(table - exact) / scale;
+      if (!(error[i] <= QUANTILE_TOLERANCE)) {   // also catches inf and nan
+         if (i < half) {
+            first = i + 1;
+         } else if (last > i) {
+            last = i;
+         }
+      }
+   }
+
+   maxError = 0.0;
+   if (first < last) {
+      low = first;
+      span = last - first;
+      for (int i = first; i < last; i++) {
+         if (error[i] > maxError) {
+            maxError = error[i];
+         }
+      }
+   } else {
+      low = 0;
+      span = 0;
+   }
+}
+
+
+
+//////////////////////////////
+//
+// QuantileTable::getExactSegments -- number of segments sampled by
+//     calling the quantile function.
+//
+
+int QuantileTable::getExactSegments(void) const {
+   return QUANTILE_SEGMENTS - span;
+}
@@ -0,0 +1,82 @@
+//
+// Inverse-CDF table sampler.
+//
+// A quantile function Q(u), the inverse of a cumulative distribution, turns
+// a uniform number u in (0, 1) into a sample of the distribution. When Q is
+// expensive (tan(), pow(log())) and its parameters change far less often
+// than samples are drawn, Q is tabulated at QUANTILE_SEGMENTS + 1 evenly
+// spaced points and interpolated linearly: the top QUANTILE_BITS of a 32 bit
+// random word select the segment and the remaining bits the position in it,
+// so a sample costs one word, two table reads and a multiply-add.
+//
+// Error bound: build() evaluates Q at every segment midpoint, where the
+// interpolation error of a smooth segment peaks, and compares it with the
+// table. Segments whose error exceeds QUANTILE_TOLERANCE, relative to
+// max(|Q(u)|, 1), are sampled by calling Q directly; this always includes
+// the two outer segments, where Q usually has a pole. So every sample is
+// within QUANTILE_TOLERANCE of the exact value (measured at the midpoints),
+// and distributions which cannot be tabulated that accurately, such as a
+// Weibull with a very small shape, transparently fall back to Q.
+//
+// The knots, 16 kB at 12 bits, are only allocated by the first build().
+//
+
+#ifndef QUANTILETABLE_H_INCLUDED
+#define QUANTILETABLE_H_INCLUDED
+
+#include <stdint.h>
+
+#define QUANTILE_BITS      (12)
+#define QUANTILE_SEGMENTS  (1 << QUANTILE_BITS)
+#define QUANTILE_TOLERANCE (1.0e-4)
+
+
+class QuantileTable {
+   public:
+      typedef double (*Quantile)(double u, double shape);
+
+                    QuantileTable ();
+                   ~QuantileTable ();
+
+      void          build         (Quantile aQuantile, double aShape);
+      bool          isBuilt       (void) const { return knot != 0; }
+      double        getShape      (void) const { return shape; }
+      double        getError      (void) const { return maxError; }
+      int           getExactSegments (void) const;
+
+      // sample for a 32-bit random word
+      double        sample        (uint32_t word) const {
+         uint32_t i = word >> (32 - QUANTILE_BITS);
+         if (i - low < span) {
+            float f = (float)(word & ((1U << (32 - QUANTILE_BITS)) - 1))
+                  * (1.0f / (1U << (32 - QUANTILE_BITS)));
+            return knot[i] + f * (knot[i + 1] - knot[i]);
+         }
+         return quantile((word + 0.5) * (1.0 / 4294967296.0), shape);
+      }
+
+      // sample for a uniform number u in [0, 1], for truncated ranges
+      double        at            (double u) const {
+         double x = u * QUANTILE_SEGMENTS;
+         uint32_t i = (uint32_t)x;
+         if (i - low < span) {
+            return knot[i] + (x - i) * (knot[i + 1] - knot[i]);
+         }
+         return quantile(u, shape);
+      }
+
+   protected:
+      Quantile      quantile;       // exact quantile function
+      double        shape;          // its parameter
+      uint32_t      low;            // first interpolated segment
+      uint32_t      span;           // number of interpolated segments
+      double        maxError;       // largest error of those segments
+      float*        knot;           // QUANTILE_SEGMENTS + 1 points
+
+   private:
+                    QuantileTable (const QuantileTable&);
+      void          operator=     (const QuantileTable&);
+};
+
+
+#endif  /* QUANTILETABLE_H_INCLUDED */
@@ -0,0 +1,132 @@
+// randomsource.h
+// Per instance source of random numbers with a runtime selectable engine.
+//
+// The engines (MTRand, SFMTRand and the ones in engines.h) all share the same
+// interface and are used as template policy parameters: code that needs
+// random numbers is written once as a template on the engine type, and
+// apply() resolves the selected engine with a single switch before calling
+// it. Bulk fills therefore run the engine's own inlined loop.
+//
+// Only the selected engine exists: the engines share the storage of a union,
+// and setEngine() destroys the old engine and constructs the new one in
+// place, seeded with a key drawn from the old one. A source is therefore
+// the size of its largest engine (MT19937, about 2.5 KB), not of all seven,
+// and switching engines allocates nothing.
+
+#ifndef RANDOMSOURCE_H
+#define RANDOMSOURCE_H
+
+#include <stdint.h>
+#include "mtrand.h"
+#include "sfmtrand.h"
+#include "engines.h"
+#include "philox.h"
+
+#define ENGINE_MT19937      (0)
+#define ENGINE_SFMT         (1)
+#define ENGINE_XOSHIRO128P  (2)
+#define ENGINE_XOSHIRO256SS (3)
+#define ENGINE_PCG32        (4)
+#define ENGINE_SPLITMIX64   (5)
+#define ENGINE_PHILOX       (6)
+
+#define NUM_ENGINES         (7)
+
+// substreams of every stream handed out by RandomSource::newStream()
+#define RANDOM_SUBSTREAMS   (64)
+
+// engine type of an engine id, for code specialised on the engine at
+// compile time (see RandomSource::engine())
+template <int Id> struct EngineOf;
+template <> struct EngineOf<ENGINE_MT19937>      { typedef MTRand type; };
+template <> struct EngineOf<ENGINE_SFMT>         { typedef SFMTRand type; };
+template <> struct EngineOf<ENGINE_XOSHIRO128P>  { typedef Xoshiro128Plus type; };
+template <> struct EngineOf<ENGINE_XOSHIRO256SS> { typedef Xoshiro256StarStar type; };
+template <> struct EngineOf<ENGINE_PCG32>        { typedef Pcg32 type; };
+template <> struct EngineOf<ENGINE_SPLITMIX64>   { typedef SplitMix64 type; };
+template <> struct EngineOf<ENGINE_PHILOX>       { typedef Philox4x32 type; };
+
+class RandomSource {
+public:
+  RandomSource() : engineType(ENGINE_MT19937) { construct(); }
+  RandomSource(unsigned long s) : engineType(ENGINE_MT19937) { construct(); seed(s); }
+  ~RandomSource() { destroy(); }
+
+  void seed(unsigned long s); // seed the selected engine
+  void seed(const unsigned long* array, int size); // seed the selected engine with array
+// streams that provably never overlap: newStream() returns a number no other
+// call in the process gets, lock free, and seedStream(stream, sub) starts the
+// selected engine at substream sub < RANDOM_SUBSTREAMS of that stream. Every
+// engine places the (stream, sub) pairs apart with its own jump ahead, further
+// than any of them will be played: MT19937 and SFMT by substream() (2^64
+// numbers, streams below 2^26), Philox by its stream number (2^66), the
+// xoshiros by long_jump() per stream and jump() per substream (2^64 and
+// more), PCG32 and SplitMix64 by advance() (2^40, streams below 2^18).
+// MT19937 and SFMT take a few ms per stream, so seed outside the audio thread
+  static uint64_t newStream();
+  void seedStream(uint64_t stream, int sub);
+// seed with a stream of its own, seedStream(newStream(), 0)
+  void seedUnique();
+  int getEngine() const { return engineType; }
+// select an engine, seeded from the previous one; returns the previous engine
+  int setEngine(int newEngine);
+
+// call op(engine) with the selected engine, op has a templated operator()
+  template <class Op> void apply(Op& op) {
+    switch (engineType) {
+      case ENGINE_SFMT:         op(engines.sfmt); break;
+      case ENGINE_XOSHIRO128P:  op(engines.xoshiro128p); break;
+      case ENGINE_XOSHIRO256SS: op(engines.xoshiro256ss); break;
+      case ENGINE_PCG32:        op(engines.pcg32); break;
+      case ENGINE_SPLITMIX64:   op(engines.splitmix64); break;
+      case ENGINE_PHILOX:       op(engines.philox); break;
+      case ENGINE_MT19937:
+      default:                  op(engines.mt); break;
+    }
+  }
+
+// the engine with id Id, only valid while Id is the selected engine
+  template <int Id> typename EngineOf<Id>::type& engine();
+
+  uint32_t rand_int32(); // generate 32 bit random integer
+  double operator()() { // double in the half-open interval [0, 1)
+    return static_cast<double>(rand_int32()) * (1. / 4294967296.); } // divided by 2^32
+  void fill_u32(uint32_t* out, int count); // bulk 32 bit integers
+  void fill(float* out, int count); // bulk floats in [0, 1)
+// random access, only the counter based engine (Philox) can seek: the numbers
+// from position n on are the same whatever was generated before. With any
+// other engine selected seek() does nothing and tell() returns 0
+  bool canSeek() const { return engineType == ENGINE_PHILOX; }
+  void seek(uint64_t position) { if (canSeek()) engines.philox.seek(position); }
+  uint64_t tell() const { return canSeek() ? engines.philox.tell() : 0; }
+
+private:
+  int engineType;
+// storage for the selected engine, constructed and destroyed by hand
+  union Engines {
+    Engines() {}
+    ~Engines() {}
+    MTRand mt;
+    SFMTRand sfmt;
+    Xoshiro128Plus xoshiro128p;
+    Xoshiro256StarStar xoshiro256ss;
+    Pcg32 pcg32;
+    SplitMix64 splitmix64;
+    Philox4x32 philox;
+  } engines;
+  void construct(); // default construct the engine engineType selects
+  void destroy(); // destroy it
+// make copy constructor and assignment operator unavailable, they don't make sense
+  RandomSource(const RandomSource&); // copy constructor not defined
+  void operator=(const RandomSource&); // assignment operator not defined
+};
+
+template <> inline MTRand& RandomSource::engine<ENGINE_MT19937>() { return engines.mt; }
+template <> inline SFMTRand& RandomSource::engine<ENGINE_SFMT>() { return engines.sfmt; }
+template <> inline Xoshiro128Plus& RandomSource::engine<ENGINE_XOSHIRO128P>() { return engines.xoshiro128p; }
+template <> inline Xoshiro256StarStar& RandomSource::engine<ENGINE_XOSHIRO256SS>() { return engines.xoshiro256ss; }
+template <> inline Pcg32& RandomSource::engine<ENGINE_PCG32>() { return engines.pcg32; }
+template <> inline SplitMix64& RandomSource::engine<ENGINE_SPLITMIX64>() { return engines.splitmix64; }
+template <> inline Philox4x32& RandomSource::engine<ENGINE_PHILOX>() { return engines.philox; }
+
+#endif // RANDOMSOURCE_H
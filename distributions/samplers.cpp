@@ -0,0 +1,46 @@
+//
+// Sampler kernel table, see samplers.h for information.
+//
+
+#include "samplers.h"
+
+
+const SamplerTable samplerTable;
+
+
+//////////////////////////////
+//
+// SamplerTableBuilder -- walks every (Type, EngineId) pair at compile time,
+//     engines first, and stores the kernel of each.
+//
+
+template <int Type, int EngineId>
+struct SamplerTableBuilder {
+   static void build(SamplerKernel (*kernel)[NUM_ENGINES]) {
+      kernel[Type][EngineId] = &samplerKernel<Type, EngineId>;
+      SamplerTableBuilder<Type, EngineId + 1>::build(kernel);
+   }
+};
+
+template <int Type>
+struct SamplerTableBuilder<Type, NUM_ENGINES> {
+   static void build(SamplerKernel (*kernel)[NUM_ENGINES]) {
+      SamplerTableBuilder<Type + 1, 0>::build(kernel);
+   }
+};
+
+template <>
+struct SamplerTableBuilder<NUM_TYPES, 0> {
+   static void build(SamplerKernel (*)[NUM_ENGINES]) { }
+};
+
+
+
+//////////////////////////////
+//
+// SamplerTable::SamplerTable --
+//
+
+SamplerTable::SamplerTable() {
+   SamplerTableBuilder<0, 0>::build(kernel);
+}
@@ -0,0 +1,601 @@
+//
+// Sampler templates and the block kernel table.
+//
+// Sampler<Type, Engine> draws values of one distribution type (UNIFORM ...
+// EMPIRICAL in distributions.h) from an Engine, anything with a rand_int32()
+// member. Its constructor copies the constants the type derives from its
+// parameters out of a Distribution, so inside a block loop they stay in
+// registers instead of being reloaded from the object for every sample.
+// Types without a specialisation fall back to Distribution::value().
+//
+// samplerKernel<Type, EngineId>() fills a block with one Sampler, fed with
+// words from the bulk output of the concrete engine, so neither the type
+// nor the engine is looked up per sample. SamplerTable holds a pointer to
+// the kernel of every type and engine pair, filled in by template recursion
+// over NUM_TYPES and NUM_ENGINES: a new type only needs its Sampler
+// specialisation and a new engine its EngineOf entry in randomsource.h.
+// SamplerBlock lets a type replace the per-sample loop of its kernel with
+// whole-block arithmetic.
+//
+
+#ifndef SAMPLERS_H_INCLUDED
+#define SAMPLERS_H_INCLUDED
+
+#include <math.h>
+#include "distributions.h"
+#include "ziggurat.h"
+#include "simdmath.h"
+
+
+//////////////////////////////
+//
+// TriangularQuantile -- inverse CDF of the triangular distribution with
+//     its peak at 0, falling to 0 at -lower and upper.
+//
+
+inline double TriangularQuantile(double u, double lower, double upper) {
+   double width = lower + upper;
+   if (u * width < lower) {
+      return sqrt(u * width * lower) - lower;
+   }
+   return upper - sqrt((1.0 - u) * width * upper);
+}
+
+
+
+//////////////////////////////
+//
+// gammaVariate -- Gamma variate with scale 1, from Marsaglia and Tsang,
+//     "A Simple Method for Generating Gamma Variables", ACM TOMS 26(3),
+//     2000.  A normal deviate is accepted with probability 0.95 or more
+//     (0.95 at shape 1, rising with the shape), mostly by the squeeze
+//     without a log().  Shapes below 1 are sampled at shape + 1 and
+//     scaled by U^(1/shape).
+//
+
+template <class Engine>
+double gammaVariate(Engine& engine, const GammaShape& shape) {
+   double result;
+   for (;;) {
+      double x, v;
+      do {
+         x = zigguratNormal(engine);
+         v = 1.0 + shape.c * x;
+      } while (v <= 0.0);
+      v = v * v * v;
+      double u = zigguratUniform(engine);
+      double x2 = x * x;
+      if (u < 1.0 - 0.0331 * x2 * x2 ||
+            log(u) < 0.5 * x2 + shape.d * (1.0 - v + log(v))) {
+         result = shape.d * v;
+         break;
+      }
+   }
+   if (shape.boost > 0.0) {
+      result *= pow(zigguratUniform(engine), shape.boost);
+   }
+   return result;
+}
+
+
+
+//////////////////////////////
+//
+// logFactorial -- log(k!) for a whole k >= 0: exact below 10, Stirling's
+//     series with four terms above (error below 1e-10).  Used instead of
+//     lgamma(), which writes the global signgam and so is not thread safe.
+//
+
+inline double logFactorial(double k) {
+   static const double small[10] = {
+         0, 0, 0.69314718055994495,
+         1.7917594692280554, 3.1780538303479449, 4.7874917427820467,
+         6.5792512120101021, 8.5251613610654147, 10.604602902745249,
+         12.801827480081467
+   };
+   if (k < 10.0) {
+      return small[(int)k];
+   }
+   double n = k + 1.0;
+   double r = 1.0 / (n * n);
+   return (n - 0.5) * log(n) - n + 0.91893853320467274178
+         + (1.0 / 12.0 - r * (1.0 / 360.0 - r * (1.0 / 1260.0
+         - r * (1.0 / 1680.0)))) / n;
+}
+
+
+
+//////////////////////////////
+//
+// poissonVariate -- Poisson variate.  Means below POISSON_INVERSION_MEAN
+//     are inverted by a sequential search from 0, taking mean + 1
+//     steps on average; above, PTRS from W. Hoermann, "The Transformed
+//     Rejection Method for Generating Poisson Random Variables",
+//     Insurance: Mathematics and Economics 12, 1993, which accepts
+//     about 9 in 10 pairs of uniforms, most without a log(), whatever
+//     the mean.
+//
+
+template <class Engine>
+double poissonVariate(Engine& engine, const PoissonShape& shape) {
+   if (shape.mean < POISSON_INVERSION_MEAN) {
+      double p = exp(-shape.mean);
+      double cdf = p;
+      double u = zigguratUniform(engine);
+      double k = 0.0;
+      while (u > cdf && p > 0.0) {
+         k += 1.0;
+         p *= shape.mean / k;
+         cdf += p;
+      }
+      return k;
+   }
+
+   for (;;) {
+      double u = zigguratUniform(engine) - 0.5;
+      double v = zigguratUniform(engine);
+      double us = 0.5 - fabs(u);
+      double k = floor((2.0 * shape.a / us + shape.b) * u + shape.mean
+            + 0.43);
+      if (us >= 0.07 && v <= shape.vr) {
+         return k;
+      }
+      if (k < 0.0 || (us < 0.013 && v > us)) {
+         continue;
+      }
+      if (log(v) + shape.logInvAlpha - log(shape.a / (us * us) + shape.b)
+            <= -shape.mean + k * shape.logMean - logFactorial(k)) {
+         return k;
+      }
+   }
+}
+
+
+
+//////////////////////////////
+//
+// binomialVariate -- Binomial variate, sampled for p <= 1/2 and
+//     reflected.  Means below BINOMIAL_INVERSION_MEAN are inverted with
+//     the recurrence of the probabilities; above, BTRS from W. Hoermann,
+//     "The Generation of Binomial Random Variates", Journal of
+//     Statistical Computation and Simulation 46, 1993.
+//
+
+template <class Engine>
+double binomialVariate(Engine& engine, const BinomialShape& shape) {
+   double k;
+   if (shape.n * shape.p < BINOMIAL_INVERSION_MEAN) {
+      double ratio = shape.p / shape.q;
+      double a = (shape.n + 1) * ratio;
+      double r = pow(shape.q, shape.n);
+      double u = zigguratUniform(engine);
+      k = 0.0;
+      while (u > r && k < shape.n) {
+         u -= r;
+         k += 1.0;
+         r *= a / k - ratio;
+      }
+   } else {
+      for (;;) {
+         double u = zigguratUniform(engine) - 0.5;
+         double v = zigguratUniform(engine);
+         double us = 0.5 - fabs(u);
+         k = floor((2.0 * shape.a / us + shape.b) * u + shape.c);
+         if (k < 0.0 || k > shape.n) {
+            continue;
+         }
+         if (us >= 0.07 && v <= shape.vr) {
+            break;
+         }
+         v = log(v * shape.alpha / (shape.a / (us * us) + shape.b));
+         if (v <= shape.h - logFactorial(k) - logFactorial(shape.n - k)
+               + (k - shape.m) * shape.logRatio) {
+            break;
+         }
+      }
+   }
+   return shape.flip ? shape.n - k : k;
+}
+
+
+
+//////////////////////////////
+//
+// BlockWords -- random words taken from an engine's fill_u32() in blocks.
+//     The first refill is sized for the samples still to be drawn, and
+//     nothing is drawn until the first word is needed.
+//
+
+template <class Engine>
+class BlockWords {
+   public:
+      BlockWords(Engine& anEngine, int expected) : engine(anEngine) {
+         size = expected < 16 ? 16 :
+               (expected > FILL_BLOCK ? FILL_BLOCK : expected);
+         next = size;
+      }
+
+      uint32_t rand_int32(void) {
+         if (next == size) {
+            engine.fill_u32(words, size);
+            next = 0;
+         }
+         return words[next++];
+      }
+
+   private:
+      Engine&       engine;
+      int           size;
+      int           next;
+      uint32_t      words[FILL_BLOCK];
+};
+
+
+
+//////////////////////////////
+//
+// Sampler -- one specialisation per distribution type.
+//
+
+template <int Type, class Engine>
+class Sampler {
+   public:
+      Sampler(Distribution& d) : distribution(d) { }
+      float operator()(Engine&) { return distribution.value(); }
+   private:
+      Distribution& distribution;
+};
+
+template <class Engine>
+class Sampler<UNIFORM, Engine> {
+   public:
+      Sampler(const Distribution& d) : low(d.uniform_low),
+            scale(d.uniform_range * (1.0 / 4294967296.0)) { }
+      float operator()(Engine& e) {
+         return (float)(low + scale * e.rand_int32());
+      }
+   private:
+      const double low, scale;
+};
+
+template <class Engine>
+class Sampler<LINEAR, Engine> {
+   public:
+      Sampler(const Distribution&) { }
+      float operator()(Engine& e) {
+         uint32_t a = e.rand_int32();
+         uint32_t b = e.rand_int32();
+         return (float)((a < b ? a : b) * (1.0 / 4294967296.0));
+      }
+};
+
+template <class Engine>
+class Sampler<TRIANGULAR, Engine> {
+   public:
+      Sampler(const Distribution& d) : peak(d.triangular_max),
+            lower(d.triangular_diffl), upper(d.triangular_diffu) { }
+      float operator()(Engine& e) {
+         double u = e.rand_int32() * (1.0 / 4294967296.0);
+         return (float)(peak + TriangularQuantile(u, lower, upper));
+      }
+   private:
+      const double peak, lower, upper;
+};
+
+template <class Engine>
+class Sampler<EXPONENTIAL, Engine> {
+   public:
+      Sampler(const Distribution& d) : scale(1.0 / d.exponential_lambda) { }
+      float operator()(Engine& e) {
+         return (float)(scale * zigguratExponential(e));
+      }
+   private:
+      const double scale;
+};
+
+template <class Engine>
+class Sampler<BILATERAL, Engine> {
+   public:
+      Sampler(const Distribution& d) : scale(1.0 / d.bilateral_lambda),
+            signBits(0), signCount(0) { }
+      float operator()(Engine& e) {
+         if (signCount == 0) {
+            signBits = e.rand_int32();
+            signCount = 32;
+         }
+         double x = scale * zigguratExponential(e);
+         uint32_t sign = signBits & 1;
+         signBits >>= 1;
+         signCount--;
+         return (float)(sign ? -x : x);
+      }
+   private:
+      const double scale;
+      uint32_t signBits;
+      int signCount;
+};
+
+template <class Engine>
+class Sampler<GAUSSIAN, Engine> {
+   public:
+      Sampler(const Distribution& d) : deviation(d.gaussian_deviation),
+            mean(d.gaussian_mean) { }
+      float operator()(Engine& e) {
+         return (float)(deviation * zigguratNormal(e) + mean);
+      }
+   private:
+      const double deviation, mean;
+};
+
+template <class Engine>
+class Sampler<CAUCHY, Engine> {
+   public:
+      Sampler(const Distribution& d) : table(d.cauchyTable),
+            spread(d.cauchy_spread), mean(d.cauchy_mean) { }
+      float operator()(Engine& e) {
+         return (float)(spread * table.sample(e.rand_int32()) + mean);
+      }
+   private:
+      const QuantileTable& table;
+      const double spread, mean;
+};
+
+template <class Engine>
+class Sampler<WEIBULL, Engine> {
+   public:
+      Sampler(const Distribution& d) : table(d.weibullTable),
+            scale(d.weibull_s) { }
+      float operator()(Engine& e) {
+         return (float)(scale * table.sample(e.rand_int32()));
+      }
+   private:
+      const QuantileTable& table;
+      const double scale;
+};
+
+template <class Engine>
+class Sampler<GAMMA, Engine> {
+   public:
+      Sampler(const Distribution& d) : shape(d.gamma_shape),
+            scale(d.gamma_scale) { }
+      float operator()(Engine& e) {
+         return (float)(scale * gammaVariate(e, shape));
+      }
+   private:
+      const GammaShape shape;
+      const double scale;
+};
+
+template <class Engine>
+class Sampler<POISSON, Engine> {
+   public:
+      Sampler(const Distribution& d) : shape(d.poisson_shape) { }
+      float operator()(Engine& e) {
+         return (float)poissonVariate(e, shape);
+      }
+   private:
+      const PoissonShape shape;
+};
+
+template <class Engine>
+class Sampler<BINOMIAL, Engine> {
+   public:
+      Sampler(const Distribution& d) : shape(d.binomial_shape) { }
+      float operator()(Engine& e) {
+         return (float)binomialVariate(e, shape);
+      }
+   private:
+      const BinomialShape shape;
+};
+
+// inversion, one word per sample; log(U) / log(1 - p) is capped before the
+// conversion for tiny p, and is 0 for p = 1
+template <class Engine>
+class Sampler<GEOMETRIC, Engine> {
+   public:
+      Sampler(const Distribution& d) : scale(1.0 / d.geometric_log_q) { }
+      float operator()(Engine& e) {
+         double k = floor(log(zigguratUniform(e)) * scale);
+         return (float)(k < 1e30 ? k : 1e30);
+      }
+   private:
+      const double scale;
+};
+
+template <class Engine>
+class Sampler<DISCRETE, Engine> {
+   public:
+      Sampler(const Distribution& d) : table(d.discreteTable) { }
+      float operator()(Engine& e) {
+         return (float)table.sample(e.rand_int32());
+      }
+   private:
+      const AliasTable& table;
+};
+
+template <class Engine>
+class Sampler<EMPIRICAL, Engine> {
+   public:
+      Sampler(const Distribution& d) : table(d.empiricalTable) { }
+      float operator()(Engine& e) {
+         return (float)table.sample(e.rand_int32());
+      }
+   private:
+      const EmpiricalTable& table;
+};
+
+// Johnk's method when a + b <= 1, where it accepts at least pi/4 of the
+// pairs, otherwise the ratio X / (X + Y) of Gamma(a) and Gamma(b) variates
+template <class Engine>
+class Sampler<BETA, Engine> {
+   public:
+      Sampler(const Distribution& d) : johnk(d.beta_a + d.beta_b <= 1.0),
+            invA(d.beta_inv_a), invB(d.beta_inv_b),
+            shapeA(d.beta_gamma_a), shapeB(d.beta_gamma_b) { }
+      float operator()(Engine& e) {
+         if (!johnk) {
+            double x = gammaVariate(e, shapeA);
+            double y = gammaVariate(e, shapeB);
+            return (float)(x / (x + y));
+         }
+         for (;;) {
+            double logx = log(zigguratUniform(e)) * invA;
+            double logy = log(zigguratUniform(e)) * invB;
+            double x = exp(logx);
+            double y = exp(logy);
+            if (x + y <= 1.0) {
+               if (x + y > 0.0) {
+                  return (float)(x / (x + y));
+               }
+               // both underflowed: divide in the log domain
+               double larger = logx > logy ? logx : logy;
+               x = exp(logx - larger);
+               y = exp(logy - larger);
+               return (float)(x / (x + y));
+            }
+         }
+      }
+   private:
+      const bool johnk;
+      const double invA, invB;
+      const GammaShape shapeA, shapeB;
+};
+
+
+
+//////////////////////////////
+//
+// SamplerBlock -- count unbounded values of Type from an Engine, count at
+//     most FILL_BLOCK.  By default one Sampler is run over BlockWords; the
+//     closed-form types below instead turn a whole block of words into
+//     open unit floats and transform them with the vector kernels of
+//     simdmath.h, one word per sample.  Their smallest unit value is
+//     2^-31, which bounds how far into the tails a block reaches.
+//
+//     So for these types value() and fill() take different paths: one
+//     sample at a time the Ziggurat (Exponential, Bilateral) and the
+//     QuantileTables (Cauchy, Weibull) are cheaper than a polynomial log,
+//     pow or cot, while a block amortises the vector kernels.  Both draw
+//     the same distribution, within QUANTILE_TOLERANCE and the bounds of
+//     simdmath.h, but not the same numbers from a given seed; the test in
+//     tests/fill_value_test.cpp compares them with the exact CDFs and with
+//     each other.
+//
+
+template <int Type, class Engine>
+struct SamplerBlock {
+   static void fill(Distribution& distribution, Engine& engine, float* out,
+         int count) {
+      BlockWords<Engine> words(engine, count);
+      Sampler<Type, BlockWords<Engine> > sampler(distribution);
+      for (int i=0; i<count; i++) {
+         out[i] = sampler(words);
+      }
+   }
+};
+
+// -log(U) / lambda
+template <class Engine>
+struct SamplerBlock<EXPONENTIAL, Engine> {
+   static void fill(Distribution& distribution, Engine& engine, float* out,
+         int count) {
+      uint32_t words[FILL_BLOCK];
+      engine.fill_u32(words, count);
+      openUnitBlock(words, out, count);
+      logBlock(out, out, count);
+      const float scale = -1.0f / distribution.exponential_lambda;
+      for (int i=0; i<count; i++) {
+         out[i] *= scale;
+      }
+   }
+};
+
+// the exponential magnitude from the low 31 bits, the sign from the top one
+template <class Engine>
+struct SamplerBlock<BILATERAL, Engine> {
+   static void fill(Distribution& distribution, Engine& engine, float* out,
+         int count) {
+      uint32_t words[FILL_BLOCK];
+      engine.fill_u32(words, count);
+      openUnitBlock(words, out, count);
+      logBlock(out, out, count);
+      const float scale = 1.0f / distribution.bilateral_lambda;
+      for (int i=0; i<count; i++) {
+         float x = out[i] * scale;
+         out[i] = (words[i] & 0x80000000U) ? x : -x;
+      }
+   }
+};
+
+// tan(pi (U - 1/2)) as +-cot(pi U / 2), which keeps the argument away from
+// the pole where pi U / 2 would lose its low bits
+template <class Engine>
+struct SamplerBlock<CAUCHY, Engine> {
+   static void fill(Distribution& distribution, Engine& engine, float* out,
+         int count) {
+      uint32_t words[FILL_BLOCK];
+      engine.fill_u32(words, count);
+      openUnitBlock(words, out, count);
+      for (int i=0; i<count; i++) {
+         out[i] *= 0.5f;
+      }
+      cotPiBlock(out, out, count);
+      const float spread = distribution.cauchy_spread;
+      const float mean = distribution.cauchy_mean;
+      for (int i=0; i<count; i++) {
+         float x = out[i] * spread;
+         out[i] = ((words[i] & 0x80000000U) ? x : -x) + mean;
+      }
+   }
+};
+
+// s (-log U)^(1/t)
+template <class Engine>
+struct SamplerBlock<WEIBULL, Engine> {
+   static void fill(Distribution& distribution, Engine& engine, float* out,
+         int count) {
+      uint32_t words[FILL_BLOCK];
+      engine.fill_u32(words, count);
+      openUnitBlock(words, out, count);
+      logBlock(out, out, count);
+      for (int i=0; i<count; i++) {
+         out[i] = -out[i];
+      }
+      powBlock(out, distribution.weibull_inv_t, out, count);
+      const float scale = distribution.weibull_s;
+      for (int i=0; i<count; i++) {
+         out[i] *= scale;
+      }
+   }
+};
+
+
+
+//////////////////////////////
+//
+// samplerKernel -- count unbounded values of Type from engine EngineId.
+//
+
+template <int Type, int EngineId>
+void samplerKernel(Distribution& distribution, RandomSource& source,
+      float* out, int count) {
+   typedef typename EngineOf<EngineId>::type Engine;
+   SamplerBlock<Type, Engine>::fill(distribution,
+         source.template engine<EngineId>(), out, count);
+}
+
+
+
+typedef void (*SamplerKernel)(Distribution& distribution,
+      RandomSource& source, float* out, int count);
+
+struct SamplerTable {
+   SamplerTable();
+
+   SamplerKernel kernel[NUM_TYPES][NUM_ENGINES];
+};
+
+extern const SamplerTable samplerTable;
+
+
+#endif  /* SAMPLERS_H_INCLUDED */
@@ -0,0 +1,305 @@
+//
+// Vectorised float transcendentals, see simdmath.h for information.
+//
+
+#include "simdmath.h"
+#include "sfmtrand.h"      // for SFMT_SSE2
+#include <string.h>
+#include <math.h>
+
+#if defined(__AVX2__)
+   #include <immintrin.h>
+#elif defined(SFMT_SSE2)
+   #include <emmintrin.h>
+#endif
+
+
+//////////////////////////////
+//
+// Vector policies: the kernels below are written once against these.
+//     V holds floats, I 32-bit ints and M comparison masks.
+//
+
+struct ScalarOps {
+   typedef float   V;
+   typedef int32_t I;
+   typedef bool    M;
+
+   static V    load   (const float* p)       { return *p; }
+   static void store  (float* p, V a)        { *p = a; }
+   static V    set    (float a)              { return a; }
+   static V    add    (V a, V b)             { return a + b; }
+   static V    sub    (V a, V b)             { return a - b; }
+   static V    mul    (V a, V b)             { return a * b; }
+   static V    div    (V a, V b)             { return a / b; }
+   static V    min    (V a, V b)             { return a < b ? a : b; }
+   static V    max    (V a, V b)             { return a > b ? a : b; }
+   static M    lt     (V a, V b)             { return a < b; }
+   static M    le     (V a, V b)             { return a <= b; }
+   static M    gt     (V a, V b)             { return a > b; }
+   static V    select (M m, V a, V b)        { return m ? a : b; }
+   static I    toInt  (V a)                  { return (I)a; }
+   static V    toFloat(I a)                  { return (V)a; }
+   static I    bits   (V a)        { I i; memcpy(&i, &a, 4); return i; }
+   static V    fromBits(I a)       { V v; memcpy(&v, &a, 4); return v; }
+   static I    iand   (I a, int32_t b)       { return a & b; }
+   static I    ior    (I a, int32_t b)       { return a | b; }
+   static I    iadd   (I a, int32_t b)       { return a + b; }
+   static I    srl    (I a, int n)   { return (I)((uint32_t)a >> n); }
+   static I    sll    (I a, int n)   { return (I)((uint32_t)a << n); }
+};
+
+#if defined(__AVX2__)
+
+struct Avx2Ops {
+   typedef __m256  V;
+   typedef __m256i I;
+   typedef __m256  M;
+
+   static V    load   (const float* p)       { return _mm256_loadu_ps(p); }
+   static void store  (float* p, V a)        { _mm256_storeu_ps(p, a); }
+   static V    set    (float a)              { return _mm256_set1_ps(a); }
+   static V    add    (V a, V b)             { return _mm256_add_ps(a, b); }
+   static V    sub    (V a, V b)             { return _mm256_sub_ps(a, b); }
+   static V    mul    (V a, V b)             { return _mm256_mul_ps(a, b); }
+   static V    div    (V a, V b)             { return _mm256_div_ps(a, b); }
+   static V    min    (V a, V b)             { return _mm256_min_ps(a, b); }
+   static V    max    (V a, V b)             { return _mm256_max_ps(a, b); }
+   static M    lt     (V a, V b)   { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+   static M    le     (V a, V b)   { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+   static M    gt     (V a, V b)   { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+   static V    select (M m, V a, V b)  { return _mm256_blendv_ps(b, a, m); }
+   static I    toInt  (V a)              { return _mm256_cvttps_epi32(a); }
+   static V    toFloat(I a)              { return _mm256_cvtepi32_ps(a); }
+   static I    bits   (V a)              { return _mm256_castps_si256(a); }
+   static V    fromBits(I a)             { return _mm256_castsi256_ps(a); }
+   static I    iand   (I a, int32_t b)
+      { return _mm256_and_si256(a, _mm256_set1_epi32(b)); }
+   static I    ior    (I a, int32_t b)
+      { return _mm256_or_si256(a, _mm256_set1_epi32(b)); }
+   static I    iadd   (I a, int32_t b)
+      { return _mm256_add_epi32(a, _mm256_set1_epi32(b)); }
+   static I    srl    (I a, int n)
+      { return _mm256_srl_epi32(a, _mm_cvtsi32_si128(n)); }
+   static I    sll    (I a, int n)
+      { return _mm256_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+};
+
+#define SIMD_WIDE Avx2Ops
+#define SIMD_WIDTH (8)
+
+#elif defined(SFMT_SSE2)
+
+struct Sse2Ops {
+   typedef __m128  V;
+   typedef __m128i I;
+   typedef __m128  M;
+
+   static V    load   (const float* p)       { return _mm_loadu_ps(p); }
+   static void store  (float* p, V a)        { _mm_storeu_ps(p, a); }
+   static V    set    (float a)              { return _mm_set1_ps(a); }
+   static V    add    (V a, V b)             { return _mm_add_ps(a, b); }
+   static V    sub    (V a, V b)             { return _mm_sub_ps(a, b); }
+   static V    mul    (V a, V b)             { return _mm_mul_ps(a, b); }
+   static V    div    (V a, V b)             { return _mm_div_ps(a, b); }
+   static V    min    (V a, V b)             { return _mm_min_ps(a, b); }
+   static V    max    (V a, V b)             { return _mm_max_ps(a, b); }
+   static M    lt     (V a, V b)             { return _mm_cmplt_ps(a, b); }
+   static M    le     (V a, V b)             { return _mm_cmple_ps(a, b); }
+   static M    gt     (V a, V b)             { return _mm_cmpgt_ps(a, b); }
+   static V    select (M m, V a, V b)
+      { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+   static I    toInt  (V a)                  { return _mm_cvttps_epi32(a); }
+   static V    toFloat(I a)                  { return _mm_cvtepi32_ps(a); }
+   static I    bits   (V a)                  { return _mm_castps_si128(a); }
+   static V    fromBits(I a)                 { return _mm_castsi128_ps(a); }
+   static I    iand   (I a, int32_t b)
+      { return _mm_and_si128(a, _mm_set1_epi32(b)); }
+   static I    ior    (I a, int32_t b)
+      { return _mm_or_si128(a, _mm_set1_epi32(b)); }
+   static I    iadd   (I a, int32_t b)
+      { return _mm_add_epi32(a, _mm_set1_epi32(b)); }
+   static I    srl    (I a, int n)
+      { return _mm_srl_epi32(a, _mm_cvtsi32_si128(n)); }
+   static I    sll    (I a, int n)
+      { return _mm_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+};
+
+#define SIMD_WIDE Sse2Ops
+#define SIMD_WIDTH (4)
+
+#endif
+
+
+
+//////////////////////////////
+//
+// logKernel -- Cephes logf: x = m 2^e with m in [sqrt(1/2), sqrt(2)),
+//     log(m) from a degree 9 polynomial in m - 1.
+//
+
+template <class Ops>
+static inline typename Ops::V logKernel(typename Ops::V x) {
+   typedef typename Ops::V V;
+   typedef typename Ops::I I;
+   const V one = Ops::set(1.0f);
+
+   typename Ops::M invalid = Ops::le(x, Ops::set(0.0f));
+   I b = Ops::bits(x);
+   V e = Ops::toFloat(Ops::iadd(Ops::srl(b, 23), -126));
+   V m = Ops::fromBits(Ops::ior(Ops::iand(b, 0x007fffff), 0x3f000000));
+
+   // m in [0.5, 1): move the lower part up to [sqrt(1/2), sqrt(2))
+   typename Ops::M small = Ops::lt(m, Ops::set(0.707106781186547524f));
+   e = Ops::sub(e, Ops::select(small, one, Ops::set(0.0f)));
+   m = Ops::sub(Ops::add(m, Ops::select(small, m, Ops::set(0.0f))), one);
+
+   V z = Ops::mul(m, m);
+   V y = Ops::set(7.0376836292E-2f);
+   y = Ops::add(Ops::mul(y, m), Ops::set(-1.1514610310E-1f));
+   y = Ops::add(Ops::mul(y, m), Ops::set(1.1676998740E-1f));
+   y = Ops::add(Ops::mul(y, m), Ops::set(-1.2420140846E-1f));
+   y = Ops::add(Ops::mul(y, m), Ops::set(1.4249322787E-1f));
+   y = Ops::add(Ops::mul(y, m), Ops::set(-1.6668057665E-1f));
+   y = Ops::add(Ops::mul(y, m), Ops::set(2.0000714765E-1f));
+   y = Ops::add(Ops::mul(y, m), Ops::set(-2.4999993993E-1f));
+   y = Ops::add(Ops::mul(y, m), Ops::set(3.3333331174E-1f));
+   y = Ops::mul(Ops::mul(y, m), z);
+
+   y = Ops::add(y, Ops::mul(e, Ops::set(-2.12194440e-4f)));
+   y = Ops::sub(y, Ops::mul(z, Ops::set(0.5f)));
+   V result = Ops::add(Ops::add(m, y), Ops::mul(e, Ops::set(0.693359375f)));
+   return Ops::select(invalid, Ops::set(-HUGE_VALF), result);
+}
+
+
+
+//////////////////////////////
+//
+// expKernel -- Cephes expf: x = n log(2) + r with |r| <= log(2)/2,
+//     exp(r) from a degree 7 polynomial, scaled by 2^n.
+//
+
+template <class Ops>
+static inline typename Ops::V expKernel(typename Ops::V x) {
+   typedef typename Ops::V V;
+   const V one = Ops::set(1.0f);
+
+   typename Ops::M under = Ops::lt(x, Ops::set(-87.3365447504f));
+   x = Ops::min(x, Ops::set(88.3762626647949f));
+   x = Ops::max(x, Ops::set(-87.3365447504f));
+
+   // n = floor(x / log(2) + 1/2), truncation corrected for negatives
+   V t = Ops::add(Ops::mul(x, Ops::set(1.44269504088896341f)),
+         Ops::set(0.5f));
+   V n = Ops::toFloat(Ops::toInt(t));
+   n = Ops::sub(n, Ops::select(Ops::gt(n, t), one, Ops::set(0.0f)));
+
+   x = Ops::sub(x, Ops::mul(n, Ops::set(0.693359375f)));
+   x = Ops::sub(x, Ops::mul(n, Ops::set(-2.12194440e-4f)));
+
+   V z = Ops::mul(x, x);
+   V y = Ops::set(1.9875691500E-4f);
+   y = Ops::add(Ops::mul(y, x), Ops::set(1.3981999507E-3f));
+   y = Ops::add(Ops::mul(y, x), Ops::set(8.3334519073E-3f));
+   y = Ops::add(Ops::mul(y, x), Ops::set(4.1665795894E-2f));
+   y = Ops::add(Ops::mul(y, x), Ops::set(1.6666665459E-1f));
+   y = Ops::add(Ops::mul(y, x), Ops::set(5.0000001201E-1f));
+   y = Ops::add(Ops::add(Ops::mul(y, z), x), one);
+
+   V scale = Ops::fromBits(Ops::sll(Ops::iadd(Ops::toInt(n), 127), 23));
+   return Ops::select(under, Ops::set(0.0f), Ops::mul(y, scale));
+}
+
+
+
+//////////////////////////////
+//
+// sinPoly, cosPoly -- Cephes sinf and cosf polynomials, for |z| <= pi/4.
+//
+
+template <class Ops>
+static inline typename Ops::V sinPoly(typename Ops::V z, typename Ops::V zz) {
+   typename Ops::V y = Ops::set(-1.9515295891E-4f);
+   y = Ops::add(Ops::mul(y, zz), Ops::set(8.3321608736E-3f));
+   y = Ops::add(Ops::mul(y, zz), Ops::set(-1.6666654611E-1f));
+   return Ops::add(Ops::mul(Ops::mul(y, zz), z), z);
+}
+
+template <class Ops>
+static inline typename Ops::V cosPoly(typename Ops::V zz) {
+   typename Ops::V y = Ops::set(2.443315711809948E-5f);
+   y = Ops::add(Ops::mul(y, zz), Ops::set(-1.388731625493765E-3f));
+   y = Ops::add(Ops::mul(y, zz), Ops::set(4.166664568298827E-2f));
+   y = Ops::mul(Ops::mul(y, zz), zz);
+   return Ops::add(Ops::sub(y, Ops::mul(zz, Ops::set(0.5f))),
+         Ops::set(1.0f));
+}
+
+
+
+//////////////////////////////
+//
+// cotPiKernel -- cot(pi a) for 0 < a <= 1/2: cos/sin of pi a up to 1/4,
+//     and tan(pi (1/2 - a)) above, where 1/2 - a is exact.
+//
+
+template <class Ops>
+static inline typename Ops::V cotPiKernel(typename Ops::V a) {
+   typedef typename Ops::V V;
+   typename Ops::M upper = Ops::gt(a, Ops::set(0.25f));
+   V r = Ops::select(upper, Ops::sub(Ops::set(0.5f), a), a);
+   V z = Ops::mul(r, Ops::set(3.14159265358979f));
+   V zz = Ops::mul(z, z);
+   V s = sinPoly<Ops>(z, zz);
+   V c = cosPoly<Ops>(zz);
+   return Ops::div(Ops::select(upper, s, c), Ops::select(upper, c, s));
+}
+
+
+
+//////////////////////////////
+//
+// The block functions: the wide policy over whole vectors, ScalarOps over
+//     what is left.
+//
+
+void logBlock(const float* x, float* out, int n) {
+   int i = 0;
+#ifdef SIMD_WIDE
+   for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+      SIMD_WIDE::store(out + i, logKernel<SIMD_WIDE>(SIMD_WIDE::load(x + i)));
+   }
+#endif
+   for (; i<n; i++) {
+      out[i] = logKernel<ScalarOps>(x[i]);
+   }
+}
+
+
+void powBlock(const float* x, float y, float* out, int n) {
+   int i = 0;
+#ifdef SIMD_WIDE
+   const SIMD_WIDE::V wideY = SIMD_WIDE::set(y);
+   for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+      SIMD_WIDE::V l = logKernel<SIMD_WIDE>(SIMD_WIDE::load(x + i));
+      SIMD_WIDE::store(out + i, expKernel<SIMD_WIDE>(SIMD_WIDE::mul(l, wideY)));
+   }
+#endif
+   for (; i<n; i++) {
+      out[i] = expKernel<ScalarOps>(logKernel<ScalarOps>(x[i]) * y);
+   }
+}
+
+
+void cotPiBlock(const float* a, float* out, int n) {
+   int i = 0;
+#ifdef SIMD_WIDE
+   for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+      SIMD_WIDE::store(out + i, cotPiKernel<SIMD_WIDE>(SIMD_WIDE::load(a + i)));
+   }
+#endif
+   for (; i<n; i++) {
+      out[i] = cotPiKernel<ScalarOps>(a[i]);
+   }
+}
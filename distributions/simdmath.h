@@ -0,0 +1,44 @@
+//
+// Vectorised float transcendentals for block sampling.
+//
+// Each function transforms a whole array, eight values per iteration with
+// AVX2 (when the module is compiled with it, __AVX2__), four with SSE2
+// (SFMT_SSE2, see sfmtrand.h), and the remainder with a scalar version of
+// the same code. The polynomials are the single precision ones of Stephen
+// Moshier's Cephes library, written once as templates on a vector policy,
+// so all paths follow the same steps.
+//
+// Maximum errors measured against double precision libm, in units in the
+// last place of the float result, the same for the scalar, SSE2 and AVX2
+// paths, with or without FMA contraction (cotPiBlock over every float in the
+// range given):
+//
+//    logBlock      1 ulp     x = 0 or a positive normal float (log 0 = -inf)
+//    powBlock      1 + 2 |y log x| ulp, x >= 0: the absolute error of log x
+//                  becomes a relative one after exp()
+//    cotPiBlock    3.9 ulp   FLT_MIN <= a <= 0.5, cot(pi a) without rounding
+//                            pi a near the pole at 0; 5 ulp for subnormal a
+//
+// openUnitBlock turns random words into the floats the samplers feed them.
+//
+
+#ifndef SIMDMATH_H_INCLUDED
+#define SIMDMATH_H_INCLUDED
+
+#include <stdint.h>
+
+// floats in (0, 1] from the low 31 bits of each word, never 0 so their log
+// is finite; the smallest is 2^-31.  Inline, so the compiler sees that the
+// samplers read only the n words their engine's fill_u32() just wrote.
+inline void openUnitBlock(const uint32_t* words, float* out, int n) {
+   for (int i=0; i<n; i++) {
+      out[i] = (float)(int32_t)((words[i] & 0x7fffffffU) | 1U)
+            * (1.0f / 2147483648.0f);
+   }
+}
+
+void  logBlock       (const float* x, float* out, int n);
+void  powBlock       (const float* x, float y, float* out, int n);
+void  cotPiBlock     (const float* a, float* out, int n);
+
+#endif  /* SIMDMATH_H_INCLUDED */
@@ -0,0 +1,128 @@
+// fill_value_test.cpp
+// Checks that Distribution::fill() and Distribution::value() sample the same
+// distribution for the closed-form types, whose two paths use different
+// algorithms (see samplers.h): both are compared with the exact CDF and with
+// each other by Kolmogorov-Smirnov tests.
+//
+//   g++ -O2 -I.. fill_value_test.cpp ../distributions.cpp ../samplers.cpp
+//       ../simdmath.cpp ../ziggurat.cpp ../quantiletable.cpp ../aliastable.cpp
+//       ../empiricaltable.cpp ../randomsource.cpp ../mtrand.cpp
+//       ../sfmtrand.cpp ../philox.cpp -o fill_value_test
+//
+// Returns 0 when every check passes.
+
+#include "distributions.h"
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+  if (!ok) {
+    printf("FAILED: %s\n", what);
+    ++failures;
+  }
+}
+
+struct Case {
+  const char* name;
+  int type;
+  double a, b; // parameters of the do...() call
+};
+
+static void setup(Distribution& d, const Case& c) {
+  switch (c.type) {
+    case EXPONENTIAL: d.doExponential((float)c.a); break;
+    case BILATERAL:   d.doBilateral((float)c.a); break;
+    case CAUCHY:      d.doCauchy((float)c.a, (float)c.b); break;
+    case WEIBULL:     d.doWeibull((float)c.a, (float)c.b); break;
+    case TRIANGULAR:  d.doTriangular((float)c.a, 0, (float)c.b); break;
+  }
+}
+
+static double cdf(const Case& c, double x) {
+  switch (c.type) {
+    case EXPONENTIAL: return x <= 0 ? 0 : -expm1(-c.a * x);
+    case BILATERAL:   return x < 0 ? 0.5 * exp(c.a * x) : 1 - 0.5 * exp(-c.a * x);
+    case CAUCHY:      return 0.5 + atan((x - c.b) / c.a) / M_PI;
+    case WEIBULL:     return x <= 0 ? 0 : -expm1(-pow(x / c.b, c.a));
+    case TRIANGULAR:  // peak at 0
+      if (x <= c.a) return 0;
+      if (x >= c.b) return 1;
+      return x < 0 ? (x - c.a) * (x - c.a) / ((c.b - c.a) * -c.a)
+                   : 1 - (c.b - x) * (c.b - x) / ((c.b - c.a) * c.b);
+  }
+  return 0;
+}
+
+// largest distance between the empirical CDF of sorted x and the exact one
+static double ksExact(const std::vector<float>& x, const Case& c) {
+  double n = (double)x.size(), d = 0;
+  for (size_t i = 0; i < x.size(); ++i) {
+    double f = cdf(c, x[i]);
+    d = std::max(d, std::max(f - i / n, (i + 1) / n - f));
+  }
+  return d;
+}
+
+// largest distance between the empirical CDFs of sorted x and y
+static double ksTwo(const std::vector<float>& x, const std::vector<float>& y) {
+  size_t i = 0, j = 0;
+  double d = 0;
+  while (i < x.size() && j < y.size()) {
+    float v = std::min(x[i], y[j]);
+    while (i < x.size() && x[i] == v) ++i;
+    while (j < y.size() && y[j] == v) ++j;
+    d = std::max(d, fabs((double)i / x.size() - (double)j / y.size()));
+  }
+  return d;
+}
+
+int main() {
+  const Case cases[] = {
+    { "exponential 1",   EXPONENTIAL, 1.0, 0 },
+    { "exponential 40",  EXPONENTIAL, 40.0, 0 },
+    { "bilateral 2",     BILATERAL, 2.0, 0 },
+    { "cauchy 1 0",      CAUCHY, 1.0, 0.0 },
+    { "cauchy 0.1 3",    CAUCHY, 0.1, 3.0 },
+    { "weibull 0.5 1",   WEIBULL, 0.5, 1.0 },
+    { "weibull 3 2",     WEIBULL, 3.0, 2.0 },
+    { "triangular -1 3", TRIANGULAR, -1.0, 3.0 },
+    { "triangular -2 2", TRIANGULAR, -2.0, 2.0 },
+  };
+  const int engines[] = { ENGINE_MT19937, ENGINE_PCG32, ENGINE_PHILOX };
+  const int n = 200000;
+// Kolmogorov-Smirnov critical distances at a level of 0.001
+  const double exact = 1.95 / sqrt((double)n);
+  const double two = 1.95 * sqrt(2.0 / n);
+
+  std::vector<float> filled(n), single(n);
+  for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); ++e) {
+    for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); ++k) {
+      const Case& c = cases[k];
+      RandomSource source(2024UL + k);
+      source.setEngine(engines[e]);
+      Distribution d(source);
+      d.setType(c.type);
+      setup(d, c);
+      d.fill(&filled[0], n, -FLT_MAX, FLT_MAX);
+      for (int i = 0; i < n; ++i) single[i] = d.value();
+      std::sort(filled.begin(), filled.end());
+      std::sort(single.begin(), single.end());
+
+      double dFill = ksExact(filled, c), dValue = ksExact(single, c);
+      double dBoth = ksTwo(filled, single);
+      printf("engine %d %-16s fill %.5f value %.5f both %.5f\n",
+             engines[e], c.name, dFill, dValue, dBoth);
+      check(dFill < exact, "fill() matches the CDF");
+      check(dValue < exact, "value() matches the CDF");
+      check(dBoth < two, "fill() and value() match each other");
+    }
+  }
+
+  printf("%d failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+//
+// Lock-free triple buffer for handing a configuration from one writer
+// thread to one reader thread.
+//
+// The three slots are owned in turn by the writer (back), by nobody (the
+// middle, the latest published one) and by the reader (front). The writer
+// fills back() and publish() swaps it with the middle; the reader calls
+// update() at a convenient point, such as the start of an audio block,
+// which swaps the front with the middle if something new was published.
+// Each side only ever touches the slot it owns, and both swaps are a single
+// atomic exchange, so neither side waits for the other, and the reader
+// always sees a slot that was completely written.
+//
+// A slot published again before the reader looked is simply replaced: the
+// reader skips to the newest one. The writer's new back slot is the one it
+// published two times ago (or the one the reader gave up), so the writer
+// must bring it up to date rather than assume it holds its last write.
+//
+
+#ifndef TRIPLEBUFFER_H_INCLUDED
+#define TRIPLEBUFFER_H_INCLUDED
+
+#include <atomic>
+
+#define TRIPLE_BUFFER_FRESH (4)     // middle index flag: not yet read
+
+
+template <class T>
+class TripleBuffer {
+   public:
+      // the slots are not owned; a starts as the front, b as the middle and
+      // c as the back
+      TripleBuffer(T* a, T* b, T* c) : middle(1), backIndex(2),
+            frontIndex(0) {
+         slot[0] = a;
+         slot[1] = b;
+         slot[2] = c;
+      }
+
+      // writer side
+      T&            back          (void)       { return *slot[backIndex]; }
+      int           getBackIndex  (void) const { return backIndex; }
+      void          publish       (void) {
+         backIndex = middle.exchange(backIndex | TRIPLE_BUFFER_FRESH,
+               std::memory_order_acq_rel) & ~TRIPLE_BUFFER_FRESH;
+      }
+
+      // reader side; update() returns true when the front has changed
+      T&            front         (void)       { return *slot[frontIndex]; }
+      bool          update        (void) {
+         if (!(middle.load(std::memory_order_relaxed) & TRIPLE_BUFFER_FRESH)) {
+            return false;
+         }
+         frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel)
+               & ~TRIPLE_BUFFER_FRESH;
+         return true;
+      }
+
+   private:
+      T*               slot[3];
+      std::atomic<int> middle;      // index, or'ed with TRIPLE_BUFFER_FRESH
+      int              backIndex;   // writer only
+      int              frontIndex;  // reader only
+
+      TripleBuffer  (const TripleBuffer&);
+      void          operator=     (const TripleBuffer&);
+};
+
+
+#endif  /* TRIPLEBUFFER_H_INCLUDED */
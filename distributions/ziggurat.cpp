@@ -0,0 +1,57 @@
+//
+// Ziggurat tables, see ziggurat.h for information.
+//
+
+#include "ziggurat.h"
+
+
+const ZigguratTables zigguratTables;
+
+
+//////////////////////////////
+//
+// ZigguratTables::ZigguratTables -- strips of the standard normal and
+//     exponential densities, as in the setup function of Marsaglia and Tsang.
+//
+
+ZigguratTables::ZigguratTables() {
+   const double m1 = 16777216.0;        // 2^24
+   const double vn = 9.91256303526217e-3;  // area of each strip
+   double dn = ZIGGURAT_NORMAL_R, tn = dn;
+   double q = vn / exp(-0.5 * dn * dn);
+
+   kn[0]   = (uint32_t)((dn / q) * m1);
+   kn[1]   = 0;
+   wn[0]   = q / m1;
+   wn[127] = dn / m1;
+   fn[0]   = 1.0;
+   fn[127] = exp(-0.5 * dn * dn);
+
+   for (int i = 126; i >= 1; i--) {
+      dn = sqrt(-2.0 * log(vn / dn + exp(-0.5 * dn * dn)));
+      kn[i + 1] = (uint32_t)((dn / tn) * m1);
+      tn = dn;
+      fn[i] = exp(-0.5 * dn * dn);
+      wn[i] = dn / m1;
+   }
+
+   const double m2 = 16777216.0;        // 2^24
+   const double ve = 3.949659822581572e-3; // area of each strip
+   double de = ZIGGURAT_EXPONENTIAL_R, te = de;
+   q = ve / exp(-de);
+
+   ke[0]   = (uint32_t)((de / q) * m2);
+   ke[1]   = 0;
+   we[0]   = q / m2;
+   we[255] = de / m2;
+   fe[0]   = 1.0;
+   fe[255] = exp(-de);
+
+   for (int i = 254; i >= 1; i--) {
+      de = -log(ve / de + exp(-de));
+      ke[i + 1] = (uint32_t)((de / te) * m2);
+      te = de;
+      fe[i] = exp(-de);
+      we[i] = de / m2;
+   }
+}
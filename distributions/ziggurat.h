@@ -0,0 +1,164 @@
+//
+// Ziggurat samplers, after George Marsaglia and Wai Wan Tsang,
+// "The Ziggurat Method for Generating Random Variables",
+// Journal of Statistical Software 5(8), 2000.
+//
+// The density is covered with horizontal strips of equal area (128 for the
+// normal, 256 for the exponential). A single 32 bit random word picks a
+// strip with its top bits and a position in it with the bits below, 25
+// signed ones for the normal and 24 for the exponential, so the two never
+// share a bit; positions are resolved to 2^-24 of the strip width, the
+// precision of a float. In about 99% of the draws that position lies inside
+// the density, so the sample costs one word, one table compare and one
+// multiply. The remaining draws go through the exact corrections in
+// zigguratNormalFix() and zigguratExponentialFix(), which also sample the
+// unbounded tail beyond the last strip.
+//
+// The samplers are templates on the engine: anything with a rand_int32()
+// member (RandomSource or any engine of randomsource.h) can be passed.
+// The tables are built once when the module is loaded and only read after.
+//
+
+#ifndef ZIGGURAT_H_INCLUDED
+#define ZIGGURAT_H_INCLUDED
+
+#include <stdint.h>
+#include <math.h>
+
+struct ZigguratTables {
+   ZigguratTables();
+
+   // standard normal, 128 strips
+   uint32_t  kn[128];      // strip acceptance bounds, scaled to 2^24
+   double    wn[128];      // strip widths, scaled by 2^-24
+   double    fn[128];      // density at the strip edges
+
+   // standard exponential, 256 strips
+   uint32_t  ke[256];      // strip acceptance bounds, scaled to 2^24
+   double    we[256];      // strip widths, scaled by 2^-24
+   double    fe[256];      // density at the strip edges
+};
+
+extern const ZigguratTables zigguratTables;
+
+#define ZIGGURAT_NORMAL_R (3.442619855899)   // start of the normal tail
+#define ZIGGURAT_EXPONENTIAL_R (7.697117470131487) // and the exponential one
+
+
+// the strip from the top 7 bits of a word, the signed position from the
+// low 25
+inline uint32_t zigguratNormalStrip(uint32_t word) {
+   return word >> 25;
+}
+
+inline int32_t zigguratNormalPosition(uint32_t word) {
+   return (int32_t)(word & 0x1ffffffU) - 0x1000000;
+}
+
+// the strip from the top 8 bits of a word, the position from the low 24
+inline uint32_t zigguratExponentialStrip(uint32_t word) {
+   return word >> 24;
+}
+
+inline uint32_t zigguratExponentialPosition(uint32_t word) {
+   return word & 0xffffffU;
+}
+
+
+// uniform in the open interval (0, 1), for the correction paths
+template <class Engine>
+inline double zigguratUniform(Engine& engine) {
+   return (engine.rand_int32() + 0.5) * (1.0 / 4294967296.0);
+}
+
+
+template <class Engine>
+double zigguratNormalFix(Engine& engine, int32_t hz, uint32_t iz) {
+   const ZigguratTables& z = zigguratTables;
+   for (;;) {
+      double x = hz * z.wn[iz];
+      if (iz == 0) {
+         // base strip: sample the tail beyond r
+         double xt, y;
+         do {
+            xt = -log(zigguratUniform(engine)) / ZIGGURAT_NORMAL_R;
+            y  = -log(zigguratUniform(engine));
+         } while (y + y < xt * xt);
+         return (hz > 0) ? ZIGGURAT_NORMAL_R + xt : -ZIGGURAT_NORMAL_R - xt;
+      }
+      if (z.fn[iz] + zigguratUniform(engine) * (z.fn[iz - 1] - z.fn[iz])
+            < exp(-0.5 * x * x)) {
+         return x;
+      }
+      uint32_t word = engine.rand_int32();
+      hz = zigguratNormalPosition(word);
+      iz = zigguratNormalStrip(word);
+      uint32_t ahz = (hz < 0) ? 0U - (uint32_t)hz : (uint32_t)hz;
+      if (ahz < z.kn[iz]) {
+         return hz * z.wn[iz];
+      }
+   }
+}
+
+
+//////////////////////////////
+//
+// zigguratNormal -- standard normal deviate.
+//
+
+template <class Engine>
+inline double zigguratNormal(Engine& engine) {
+   const ZigguratTables& z = zigguratTables;
+   uint32_t word = engine.rand_int32();
+   int32_t hz = zigguratNormalPosition(word);
+   uint32_t iz = zigguratNormalStrip(word);
+   uint32_t ahz = (hz < 0) ? 0U - (uint32_t)hz : (uint32_t)hz;
+   if (ahz < z.kn[iz]) {
+      return hz * z.wn[iz];
+   }
+   return zigguratNormalFix(engine, hz, iz);
+}
+
+
+template <class Engine>
+double zigguratExponentialFix(Engine& engine, uint32_t jz, uint32_t iz) {
+   const ZigguratTables& z = zigguratTables;
+   for (;;) {
+      if (iz == 0) {
+         // base strip: the tail beyond r is r plus a standard exponential
+         return ZIGGURAT_EXPONENTIAL_R - log(zigguratUniform(engine));
+      }
+      double x = jz * z.we[iz];
+      if (z.fe[iz] + zigguratUniform(engine) * (z.fe[iz - 1] - z.fe[iz])
+            < exp(-x)) {
+         return x;
+      }
+      uint32_t word = engine.rand_int32();
+      jz = zigguratExponentialPosition(word);
+      iz = zigguratExponentialStrip(word);
+      if (jz < z.ke[iz]) {
+         return jz * z.we[iz];
+      }
+   }
+}
+
+
+//////////////////////////////
+//
+// zigguratExponential -- standard exponential deviate (rate 1).
+//
+
+template <class Engine>
+inline double zigguratExponential(Engine& engine) {
+   const ZigguratTables& z = zigguratTables;
+   uint32_t word = engine.rand_int32();
+   uint32_t jz = zigguratExponentialPosition(word);
+   uint32_t iz = zigguratExponentialStrip(word);
+   if (jz < z.ke[iz]) {
+      return jz * z.we[iz];
+   }
+   return zigguratExponentialFix(engine, jz, iz);
+}
+
+
+#endif  /* ZIGGURAT_H_INCLUDED */
@@ -72,17 +72,39 @@ void DestroyModule(void* pModule)
 // module constructors/destructors
 //-------------------------------------------------------------------------
 
+// makes those of the first count sources of engine that do not exist yet,
+// channel c on substream c of stream, so that no two channels or instances
+// can overlap
+static void growSources (RandomSource** channelSources, int count, int engine,
+	uint64_t stream)
+{
+	for (int c = 0; c < count; c++){
+		if (!channelSources[c]){
+			channelSources[c] = new RandomSource();
+			channelSources[c]->setEngine(engine);
+			channelSources[c]->seedStream(stream, c);
+		}
+	}
+}
+
 // constructor
 TemplateModule::TemplateModule()
+	: engine(ENGINE_MT19937), channels(1), triggers(0), seekTo(-1),
+	  instanceStream(RandomSource::newStream()), sources(), sourcesMade(1),
+	  lfo(MAX_CHANNELS), lfoRate(eButton), sampleRate(44100.0)
 {
 	rate = 0;
-	mt.seed(static_cast<long int>(time(NULL)));
+	growSources(sources[ENGINE_MT19937], 1, ENGINE_MT19937, instanceStream);
 }
 
 // destructor
 TemplateModule::~TemplateModule()
 {
-	// 
+	for (int e = 0; e < NUM_ENGINES; e++){
+		for (int c = 0; c < MAX_CHANNELS; c++){
+			delete sources[e][c];
+		}
+	}
 }
 
 
@@ -104,7 +126,12 @@ void TemplateModule::onGetModuleInfo (MasterInfo* pMasterInfo, ModuleInfo* pModu
 // query system and init
 int  TemplateModule::onGetNumberOfParams( int QIdx) {return 0;}
 void TemplateModule::onAfterQuery (MasterInfo* pMasterInfo, ModuleInfo* pModuleInfo, int QIdx) {}
-void TemplateModule::onInitModule (MasterInfo* pMasterInfo, ModuleInfo* pModuleInfo) {}
+void TemplateModule::onInitModule (MasterInfo* pMasterInfo, ModuleInfo* pModuleInfo)
+{
+	sampleRate = sdkGetSampleRate();
+	if (scratch.empty())
+		scratch.resize(sdkGetBlocSize());   // until onBlocSizeChange
+}
 
 //-----------------------------------------------------------------------------
 // parameters and process
@@ -119,7 +146,19 @@ void TemplateModule::onGetParamInfo (int ParamIndex, TParamInfo* pParamInfo)
 		pParamInfo->Caption				= "Rate";
 		pParamInfo->IsInput				= TRUE;
 		pParamInfo->IsOutput			= FALSE;
-		pParamInfo->ListBoxStrings		= "\"Button\",\"Control\",\"Audio\"";
+		pParamInfo->ListBoxStrings		= "\"Button\",\"Control\",\"Audio\",\"Step\",\"Linear\",\"Cosine\",\"Cubic\"";
+		pParamInfo->DefaultValue		= 0; 
+		pParamInfo->ReadOnly			= FALSE;
+		pParamInfo->IsStoredInPreset	= TRUE;
+		pParamInfo->CallBackType		= ctImmediate;
+		break;
+
+	case eEngine:
+		pParamInfo->ParamType			= ptListBox;
+		pParamInfo->Caption				= "Engine";
+		pParamInfo->IsInput				= TRUE;
+		pParamInfo->IsOutput			= FALSE;
+		pParamInfo->ListBoxStrings		= "\"MT19937\",\"SFMT\",\"xoshiro128+\",\"xoshiro256**\",\"PCG32\",\"SplitMix64\",\"Philox\"";
 		pParamInfo->DefaultValue		= 0; 
 		pParamInfo->ReadOnly			= FALSE;
 		pParamInfo->IsStoredInPreset	= TRUE;
@@ -140,6 +179,62 @@ void TemplateModule::onGetParamInfo (int ParamIndex, TParamInfo* pParamInfo)
 		pParamInfo->IsOutput		= TRUE;
 		pParamInfo->ReadOnly		= TRUE;
 		break;
+	case eFrequency:
+		pParamInfo->ParamType			= ptDataFader;
+		pParamInfo->Caption				= "Frequency";
+		pParamInfo->IsInput				= TRUE;
+		pParamInfo->IsOutput			= FALSE;
+		pParamInfo->DefaultValue		= 1.0f; 
+		pParamInfo->MinValue            = 0.01f;
+		pParamInfo->MaxValue            = 20000.0f;
+		pParamInfo->ReadOnly			= FALSE;
+		pParamInfo->IsStoredInPreset	= TRUE;
+		pParamInfo->CallBackType		= ctImmediate;
+		pParamInfo->Symbol			    = "Hz";
+		pParamInfo->Format			    = "%.2f";
+		break;
+	case eChannels:
+		pParamInfo->ParamType			= ptDataFader;
+		pParamInfo->Caption				= "Channels";
+		pParamInfo->IsInput				= TRUE;
+		pParamInfo->IsOutput			= FALSE;
+		pParamInfo->DefaultValue		= 1; 
+		pParamInfo->MinValue            = 1;
+		pParamInfo->MaxValue            = MAX_CHANNELS;
+		pParamInfo->ReadOnly			= FALSE;
+		pParamInfo->IsStoredInPreset	= TRUE;
+		pParamInfo->CallBackType		= ctImmediate;
+		pParamInfo->Symbol			    = " ";
+		pParamInfo->Format			    = "%.0f";
+		break;
+	case ePosition:
+		pParamInfo->ParamType			= ptDataField;
+		pParamInfo->Caption				= "Position";
+		pParamInfo->IsInput				= TRUE;
+		pParamInfo->IsOutput			= FALSE;
+		pParamInfo->DefaultValue		= 0; 
+		pParamInfo->MinValue            = 0;
+		pParamInfo->MaxValue            = std::numeric_limits<float>::max();
+		pParamInfo->ReadOnly			= FALSE;
+		pParamInfo->IsStoredInPreset	= FALSE;
+		pParamInfo->CallBackType		= ctImmediate;
+		pParamInfo->Symbol			    = "smp";
+		pParamInfo->Format			    = "%.0f";
+		break;
+	case eSeconds:
+		pParamInfo->ParamType			= ptDataField;
+		pParamInfo->Caption				= "Seconds";
+		pParamInfo->IsInput				= TRUE;
+		pParamInfo->IsOutput			= FALSE;
+		pParamInfo->DefaultValue		= 0; 
+		pParamInfo->MinValue            = 0;
+		pParamInfo->MaxValue            = std::numeric_limits<float>::max();
+		pParamInfo->ReadOnly			= FALSE;
+		pParamInfo->IsStoredInPreset	= FALSE;
+		pParamInfo->CallBackType		= ctImmediate;
+		pParamInfo->Symbol			    = "s";
+		pParamInfo->Format			    = "%.3f";
+		break;
 
 		// default case
 	default:
@@ -156,18 +251,42 @@ void TemplateModule::onSetEventAddress (int ParamIndex, UsineEventPtr pEvent)
 	case eRate:
 		params[eRate] = pEvent;
 		break;
+	case eEngine:
+		params[eEngine] = pEvent;
+		break;
 	case eTrigger:
 		params[eTrigger] = pEvent;
 		break;
 	case eOut:
 		params[eOut] = pEvent;
 		break;
+	case eChannels:
+		params[eChannels] = pEvent;
+		break;
+	case eFrequency:
+		params[eFrequency] = pEvent;
+		break;
+	case ePosition:
+		params[ePosition] = pEvent;
+		break;
+	case eSeconds:
+		params[eSeconds] = pEvent;
+		break;
 
 		// default case
 	default:
 		break;
 	}
 }
+// the number of the stream at seconds plus samples, both rounded to whole
+// samples; a float holds every integer below 2^24, so giving whole seconds
+// and the samples after them keeps any song position exact
+static int64_t streamPosition (float seconds, float samples, double rate)
+{
+	double position = std::floor(seconds * rate + 0.5) + std::floor(samples + 0.5);
+	return (int64_t)std::max(0.0, std::min(position, 9.0e18));
+}
+
 void TemplateModule::onCallBack (UsineMessage *Message) {
 
 	switch (Message->wParam) 
@@ -175,14 +294,55 @@ void TemplateModule::onCallBack (UsineMessage *Message) {
 	case eRate:
 		rate = (int)sdkGetEvtData(params[eRate]);
 		break;
+	case eEngine:
+		{
+			int selected;
+			switch((int)sdkGetEvtData(params[eEngine])){
+				case eSFMT: selected = ENGINE_SFMT;break;
+				case eXoshiro128p: selected = ENGINE_XOSHIRO128P;break;
+				case eXoshiro256ss: selected = ENGINE_XOSHIRO256SS;break;
+				case ePCG32: selected = ENGINE_PCG32;break;
+				case eSplitMix64: selected = ENGINE_SPLITMIX64;break;
+				case ePhilox: selected = ENGINE_PHILOX;break;
+				default: selected = ENGINE_MT19937;break;
+			}
+			// its sources exist before onProcess sees it, which switches
+			// at the next block
+			growSources(sources[selected], sourcesMade, selected, instanceStream);
+			engine.store(selected, std::memory_order_release);
+		}
+		break;
 	case eTrigger:
-		if(Message->lParam == MSG_CHANGE && sdkGetEvtData(params[eRate]) == eButton){
-			sdkSetEvtData(params[eOut], (float)mt());
+		// answered by onProcess at the next block
+		if(Message->lParam == MSG_CHANGE){
+			triggers.fetch_add(1, std::memory_order_relaxed);
 		} 
 		break;
 	case eOut:
 		//params[eOut] = pEvent;
 		break;
+	case eChannels:
+		{
+			// the new channels' sources exist, for every engine onProcess
+			// may still be on, before it sees them
+			int count = std::max(1, std::min(MAX_CHANNELS, (int)(sdkGetEvtData(params[eChannels]) + 0.5f)));
+			if (count > sourcesMade){
+				for (int e = 0; e < NUM_ENGINES; e++){
+					if (sources[e][0])
+						growSources(sources[e], count, e, instanceStream);
+				}
+				sourcesMade = count;
+			}
+			channels.store(count, std::memory_order_release);
+		}
+		break;
+	case ePosition:
+	case eSeconds:
+		// sought by onProcess at the next block
+		seekTo.store(streamPosition(sdkGetEvtData(params[eSeconds]),
+				sdkGetEvtData(params[ePosition]), sampleRate),
+				std::memory_order_relaxed);
+		break;
 
 		// default case
 	default:
@@ -191,14 +351,91 @@ void TemplateModule::onCallBack (UsineMessage *Message) {
 }
 void TemplateModule::onProcess () {
 
-	if(sdkGetEvtData(params[eRate]) == eControl){
-		sdkSetEvtSize(params[eOut], 1);
-		sdkSetEvtData(params[eOut], (float)mt());
-	}else if (sdkGetEvtData(params[eRate]) == eAudio){
+	// pick up the choices made since the last block, and the sources of
+	// the engine
+	const int blockEngine = engine.load(std::memory_order_acquire);
+	const int blockChannels = channels.load(std::memory_order_acquire);
+	RandomSource** channelSources = sources[blockEngine];
+
+	// a new position, for the engines which can seek: with one number per
+	// sample, the block then starts at that sample of every channel's stream
+	const int64_t position = seekTo.exchange(-1, std::memory_order_relaxed);
+	if (position >= 0 && channelSources[0]->canSeek()){
+		for (int c = 0; c < blockChannels; c++){
+			channelSources[c]->seek((uint64_t)position);
+		}
+		lfo.restart();
+	}
+
+	// one value per channel, or one block interleaved by frame
+	const int blockRate = (int)sdkGetEvtData(params[eRate]);
+	if((triggers.exchange(0, std::memory_order_relaxed) > 0 && blockRate == eButton)
+			|| blockRate == eControl){
+		sdkSetEvtSize(params[eOut], blockChannels);
+		TPrecision* out = sdkGetEvtDataAddr(params[eOut]);
+		for (int c = 0; c < blockChannels; c++){
+			out[c] = nextValue(*channelSources[c]);
+		}
+	}else if (blockRate == eAudio){
+		// generated straight into the event's buffer (TPrecision is float)
+		int sampleFrames = sdkGetBlocSize();
+		sdkSetEvtSize(params[eOut], sampleFrames * blockChannels);
+		TPrecision* out = sdkGetEvtDataAddr(params[eOut]);
+		if (blockChannels == 1){
+			channelSources[0]->fill(out, sampleFrames);
+		}else{
+			fillChannels(channelSources, out, sampleFrames, blockChannels);
+		}
+	}else if (blockRate >= eStep && blockRate <= eCubic){
+		// one draw per channel and segment, the rest is interpolation
+		struct Draw {
+			TemplateModule* module;
+			RandomSource** channelSources;
+			float operator() (int c) { return module->nextValue(*channelSources[c]); }
+		} draw = {this, channelSources};
+		if (lfoRate < eStep || lfoRate > eCubic)
+			lfo.restart();
+		lfo.setShape(INTERP_STEP + blockRate - eStep);
+		lfo.setIncrement(sdkGetEvtData(params[eFrequency]) / sampleRate);
+		lfo.setLimits(0.f, 1.f);
 		int sampleFrames = sdkGetBlocSize();
-		sdkSetEvtSize(params[eOut], sampleFrames);
-		for (int i = 0; i < sampleFrames; i++){   
-			sdkSetEvtArrayData(params[eOut], i, (float)mt());
+		sdkSetEvtSize(params[eOut], sampleFrames * blockChannels);
+		lfo.fill(sdkGetEvtDataAddr(params[eOut]), sampleFrames, blockChannels, draw);
+	}
+	lfoRate = blockRate;
+}
+
+//-------------------------------------------------------------------------
+// private methodes
+//-------------------------------------------------------------------------
+
+// one value in [0, 1) from the selected engine of channelSource
+float TemplateModule::nextValue (RandomSource& channelSource) {
+	float value;
+	channelSource.fill(&value, 1);
+	return value;
+}
+
+// frames samples of count channels, interleaved by frame into out; each
+// channel is filled from its own source of channelSources into scratch,
+// sized by the callbacks for one block, and a longer block is done in
+// several runs so the audio thread never allocates
+void TemplateModule::fillChannels (RandomSource** channelSources, float* out,
+	int frames, int count) {
+	const int run = (int)scratch.size();
+	if (run == 0){
+		std::fill(out, out + frames * count, 0.f);
+		return;
+	}
+	float* block = &scratch[0];
+	for (int c = 0; c < count; c++){
+		for (int start = 0; start < frames; start += run){
+			int length = std::min(run, frames - start);
+			channelSources[c]->fill(block, length);
+			float* channel = out + start * count + c;
+			for (int i = 0; i < length; i++){
+				channel[i * count] = block[i];
+			}
 		}
 	}
 }
@@ -233,8 +470,14 @@ void TemplateModule::onBringToFront() {}
 
 //-----------------------------------------------------------------------------
 // audio setup update
-void TemplateModule::onBlocSizeChange (int BlocSize) {}
-void TemplateModule::onSampleRateChange (double SampleRate) {}
+void TemplateModule::onBlocSizeChange (int BlocSize)
+{
+	scratch.resize(BlocSize);
+}
+void TemplateModule::onSampleRateChange (double SampleRate)
+{
+	sampleRate = SampleRate;
+}
 
 //-----------------------------------------------------------------------------
 // recording 
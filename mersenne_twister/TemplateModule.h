@@ -56,8 +56,12 @@
 #include <iostream>
 #include <cmath>
 #include <limits>
+#include <algorithm>
+#include <vector>
+#include <atomic>
 
-#include "mtrand.h"
+#include "randomsource.h"
+#include "interpolator.h"
 #include <time.h>
 //-----------------------------------------------------------------------------
 // defines and constantes
@@ -68,6 +72,11 @@
       eRate = 0,
       eTrigger,
 	  eOut,
+	  eEngine,                      // added after the original parameters,
+	  eChannels,                    //   so saved patches keep their values
+	  eFrequency,
+	  ePosition,
+	  eSeconds,                     // whole seconds before ePosition
 
       eNumParams
   };
@@ -76,10 +85,31 @@
       eButton = 0,
       eControl,
 	  eAudio,
+	  eStep,                        // new values at eFrequency, held
+	  eLinear,                      //   or interpolated
+	  eCosine,
+	  eCubic,
 
       eNumRates
   };
 
+    enum EEngines {
+      eMT19937 = 0,
+      eSFMT,
+      eXoshiro128p,
+      eXoshiro256ss,
+      ePCG32,
+      eSplitMix64,
+      ePhilox,
+
+      eNumEngines
+  };
+
+#define MAX_CHANNELS (32)           // independent streams of one module
+#if MAX_CHANNELS > RANDOM_SUBSTREAMS
+#error "every channel needs a substream"
+#endif
+
 //-----------------------------------------------------------------------------
 // structures and typedef
 //-----------------------------------------------------------------------------
@@ -177,8 +207,28 @@ protected:
 	UsineEventPtr params[eNumParams];
 
 	int rate;
+
+	// set by onCallBack, applied by onProcess at the start of a block, so
+	// the sources onProcess can see are only used from the audio thread
+	std::atomic<int> engine;        // ENGINE_ id of the selected engine
+	std::atomic<int> channels;
+	std::atomic<int> triggers;      // eTrigger presses not yet answered
+	std::atomic<int64_t> seekTo;    // eSeconds and ePosition not yet applied,
+	                                //   -1 for none
 	
-	MTRand mt;
+	// one source per engine and channel, on substream c of instanceStream,
+	// used by onProcess only; onCallBack makes those of an engine before it
+	// first publishes that engine or that many channels, and they are kept
+	// to the end, so that switching engines back resumes the streams
+	uint64_t instanceStream;
+	RandomSource* sources[NUM_ENGINES][MAX_CHANNELS];
+	int sourcesMade;                // channels every made engine has, callback side
+	std::vector<float> scratch;     // one channel's block before interleaving
+
+	// held and interpolated rates, onProcess only
+	Interpolator lfo;
+	int lfoRate;                    // rate of the previous block
+	double sampleRate;
 	
     // protected members goes here
   
@@ -188,6 +238,9 @@ protected:
 private:  
 
     // private methodes goes here
+	float nextValue (RandomSource& channelSource);
+	void fillChannels (RandomSource** channelSources, float* out, int frames,
+		int count);
 
 }; // class TemplateModule
 
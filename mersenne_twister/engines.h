@@ -0,0 +1,223 @@
+// engines.h
+// Small fast pseudo random number engines, usable everywhere an MTRand is.
+//
+// Xoshiro128Plus and Xoshiro256StarStar are the xoshiro generators by
+// David Blackman and Sebastiano Vigna (2018), http://prng.di.unimi.it/
+// Pcg32 is the PCG XSH RR 64/32 generator by Melissa O'Neill (2014),
+// http://www.pcg-random.org/
+// SplitMix64 is the generator from Guy L. Steele, Doug Lea and Christine
+// H. Flood, "Fast splittable pseudorandom number generators" (2014), as
+// written by Sebastiano Vigna.
+// The reference implementations are public domain (xoshiro, SplitMix64) and
+// Apache 2.0 licensed (PCG).
+//
+// Every engine follows the same interface as MTRand and SFMTRand, so they can
+// be used as a template policy parameter:
+//   void seed(unsigned long)              seed with 32 bit integer
+//   void seed(const unsigned long*, int)  seed with array
+//   uint32_t rand_int32()                 generate 32 bit random integer
+//   double operator()()                   double in the half-open interval [0, 1)
+//   void fill_u32(uint32_t*, int count)   bulk 32 bit random integers
+//   void fill(float*, int count)          bulk floats in [0, 1)
+// Their whole state is a few 32 or 64 bit words, so it lives inline in the
+// object that owns the engine and stays in registers inside the fill loops.
+// Each can also skip far ahead in its sequence, for streams that provably do
+// not overlap: jump() and long_jump() of the xoshiro generators use the jump
+// polynomials of the reference code, advance() of Pcg32 and SplitMix64 any
+// distance in O(log distance).
+
+#ifndef ENGINES_H
+#define ENGINES_H
+
+#include <stdint.h>
+
+// the SplitMix64 output function, also used to expand seeds for the others
+inline uint64_t splitmix64_next(uint64_t& x) {
+  uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+// folds a seed array of 32 bit ints into one 64 bit seed
+inline uint64_t fold_seed(const unsigned long* array, int size) {
+  uint64_t x = 0;
+  for (int i = 0; i < size; ++i) x = splitmix64_next(x) ^ static_cast<uint32_t>(array[i]);
+  return x;
+}
+
+// common part of the engines: the derived class only provides rand_int32()
+// and must be cheap to copy, so the bulk loops can run on a local copy of it
+template <class Engine>
+class EngineBase {
+public:
+// generates double floating point numbers in the half-open interval [0, 1)
+  double operator()() {
+    return static_cast<double>(self().rand_int32()) * (1. / 4294967296.); } // divided by 2^32
+  void fill_u32(uint32_t* out, int count) { // bulk 32 bit integers
+    Engine e = self(); // local copy, out cannot alias its state
+    for (int i = 0; i < count; ++i) out[i] = e.rand_int32();
+    self() = e;
+  }
+  void fill(float* out, int count) { // bulk floats in [0, 1), upper 24 bits
+    Engine e = self();
+    for (int i = 0; i < count; ++i)
+      out[i] = static_cast<float>(static_cast<int32_t>(e.rand_int32() >> 8)) * (1.f / 16777216.f);
+    self() = e;
+  }
+private:
+  Engine& self() { return static_cast<Engine&>(*this); }
+};
+
+// xoshiro128+, 128 bits of state, period 2^128 - 1
+// the upper bits are the strong ones, which are the ones fill() keeps
+class Xoshiro128Plus : public EngineBase<Xoshiro128Plus> {
+public:
+  Xoshiro128Plus() { seed(5489UL); }
+  Xoshiro128Plus(unsigned long s) { seed(s); }
+  void seed(unsigned long s) { seed64(s); }
+  void seed(const unsigned long* array, int size) { seed64(fold_seed(array, size)); }
+  void seed64(uint64_t s) {
+    uint64_t x = s;
+    uint64_t a = splitmix64_next(x), b = splitmix64_next(x);
+    state[0] = static_cast<uint32_t>(a); state[1] = static_cast<uint32_t>(a >> 32);
+    state[2] = static_cast<uint32_t>(b); state[3] = static_cast<uint32_t>(b >> 32);
+  }
+  uint32_t rand_int32() {
+    const uint32_t result = state[0] + state[3];
+    const uint32_t t = state[1] << 9;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = (state[3] << 11) | (state[3] >> 21);
+    return result;
+  }
+  void jump() { // skip 2^64 numbers
+    static const uint32_t poly[4] = { 0x8764000bU, 0xf542d2d3U, 0x6fa035c3U, 0x77f2db5bU };
+    jump_by(poly);
+  }
+  void long_jump() { // skip 2^96 numbers
+    static const uint32_t poly[4] = { 0xb523952eU, 0x0b6f099fU, 0xccf5a0efU, 0x1c580662U };
+    jump_by(poly);
+  }
+private:
+  void jump_by(const uint32_t* poly) { // state = poly(transition) state
+    uint32_t s[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < 4; ++i)
+      for (int b = 0; b < 32; ++b) {
+        if ((poly[i] >> b) & 1U)
+          for (int k = 0; k < 4; ++k) s[k] ^= state[k];
+        rand_int32();
+      }
+    for (int k = 0; k < 4; ++k) state[k] = s[k];
+  }
+  uint32_t state[4];
+};
+
+// xoshiro256**, 256 bits of state, period 2^256 - 1
+// returns the upper half of each 64 bit output
+class Xoshiro256StarStar : public EngineBase<Xoshiro256StarStar> {
+public:
+  Xoshiro256StarStar() { seed(5489UL); }
+  Xoshiro256StarStar(unsigned long s) { seed(s); }
+  void seed(unsigned long s) { seed64(s); }
+  void seed(const unsigned long* array, int size) { seed64(fold_seed(array, size)); }
+  void seed64(uint64_t s) {
+    uint64_t x = s;
+    for (int i = 0; i < 4; ++i) state[i] = splitmix64_next(x);
+  }
+  uint64_t rand_int64() {
+    const uint64_t result = rotl(state[1] * 5, 7) * 9;
+    const uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+    return result;
+  }
+  uint32_t rand_int32() { return static_cast<uint32_t>(rand_int64() >> 32); }
+  void jump() { // skip 2^128 numbers
+    static const uint64_t poly[4] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+      0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+    jump_by(poly);
+  }
+  void long_jump() { // skip 2^192 numbers
+    static const uint64_t poly[4] = { 0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL,
+      0x77710069854ee241ULL, 0x39109bb02acbe635ULL };
+    jump_by(poly);
+  }
+private:
+  static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+  void jump_by(const uint64_t* poly) { // state = poly(transition) state
+    uint64_t s[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < 4; ++i)
+      for (int b = 0; b < 64; ++b) {
+        if ((poly[i] >> b) & 1U)
+          for (int k = 0; k < 4; ++k) s[k] ^= state[k];
+        rand_int64();
+      }
+    for (int k = 0; k < 4; ++k) state[k] = s[k];
+  }
+  uint64_t state[4];
+};
+
+// PCG32 (XSH RR 64/32), 64 bits of state plus a 64 bit stream selector
+class Pcg32 : public EngineBase<Pcg32> {
+public:
+  Pcg32() { seed(5489UL); }
+  Pcg32(unsigned long s) { seed(s); }
+  void seed(unsigned long s) { seed64(s); }
+  void seed(const unsigned long* array, int size) { seed64(fold_seed(array, size)); }
+  void seed64(uint64_t s) {
+    uint64_t x = s;
+    uint64_t initstate = splitmix64_next(x);
+    seed(initstate, splitmix64_next(x));
+  }
+  void seed(uint64_t initstate, uint64_t initseq) { // pcg32_srandom_r()
+    state = 0U;
+    inc = (initseq << 1) | 1U;
+    rand_int32();
+    state += initstate;
+    rand_int32();
+  }
+  uint32_t rand_int32() {
+    const uint64_t old = state;
+    state = old * 6364136223846793005ULL + inc;
+    const uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+    const uint32_t rot = static_cast<uint32_t>(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+  }
+  void advance(uint64_t delta) { // skip delta numbers, pcg32_advance_r()
+    uint64_t mult = 6364136223846793005ULL, plus = inc, acc_mult = 1U, acc_plus = 0U;
+    for (; delta > 0; delta >>= 1) {
+      if (delta & 1U) { acc_mult *= mult; acc_plus = acc_plus * mult + plus; }
+      plus = (mult + 1U) * plus;
+      mult *= mult;
+    }
+    state = acc_mult * state + acc_plus;
+  }
+private:
+  uint64_t state, inc;
+};
+
+// SplitMix64, 64 bits of state, period 2^64
+// returns the upper half of each 64 bit output
+class SplitMix64 : public EngineBase<SplitMix64> {
+public:
+  SplitMix64() { seed(5489UL); }
+  SplitMix64(unsigned long s) { seed(s); }
+  void seed(unsigned long s) { seed64(s); }
+  void seed(const unsigned long* array, int size) { seed64(fold_seed(array, size)); }
+  void seed64(uint64_t s) { state = s; }
+  uint64_t rand_int64() { return splitmix64_next(state); }
+  uint32_t rand_int32() { return static_cast<uint32_t>(rand_int64() >> 32); }
+  void advance(uint64_t delta) { state += delta * 0x9E3779B97F4A7C15ULL; } // skip delta numbers
+private:
+  uint64_t state;
+};
+
+#endif // ENGINES_H
@@ -1,13 +1,80 @@
 // mtrand.cpp, see include file mtrand.h for information
 
 #include "mtrand.h"
-// non-inline function definitions and static member definitions cannot
-// reside in header file because of the risk of multiple declarations
+#include <string.h>
+// non-inline function definitions cannot reside in header file
+// because of the risk of multiple declarations
 
-// initialization of static private members
-unsigned long MTRand_int32::state[n] = {0x0UL};
-int MTRand_int32::p = 0;
-bool MTRand_int32::init = false;
+// polynomial arithmetic over GF(2) used by jump_ahead(), a polynomial is an
+// array of 64 bit words with the coefficient of x^i in bit i
+namespace {
+
+const int mt_degree = 19937; // degree of the characteristic polynomial
+const int poly_words = (mt_degree + 63) / 64; // words of a reduced polynomial
+
+// exponents below mt_degree of the characteristic polynomial of MT19937,
+// found with the Berlekamp-Massey algorithm on the generator output
+const int mt_charpoly[] = {
+  0, 1189, 1416, 1585, 1643, 1870, 2493, 2773, 3000, 3227,
+  3454, 3681, 3908, 4135, 4362, 4753, 5661, 6337, 6569, 7129,
+  7477, 7525, 7583, 7752, 7979, 8206, 9505, 9901, 9969, 10128,
+  10693, 10761, 10920, 11089, 11147, 11157, 11215, 11321, 11374, 11384,
+  11485, 11611, 11712, 11717, 11838, 11881, 11944, 11997, 12277, 12335,
+  12393, 12504, 12509, 12620, 12673, 12731, 12736, 12789, 12905, 12958,
+  12963, 13137, 13185, 13190, 13243, 13301, 13412, 13528, 13533, 13639,
+  13697, 13760, 13813, 13866, 14093, 14151, 14209, 14320, 14325, 14436,
+  14547, 14552, 14605, 14721, 14774, 14779, 14953, 15001, 15006, 15059,
+  15117, 15228, 15344, 15349, 15455, 15513, 15576, 15629, 15682, 15909,
+  15967, 16025, 16136, 16141, 16252, 16363, 16368, 16421, 16537, 16590,
+  16595, 16817, 16822, 16875, 16933, 17044, 17160, 17271, 17329, 17445,
+  17498, 17725, 17783, 17841, 17952, 18068, 18179, 18237, 18406, 18633,
+  18691, 18860, 19087, 19314,
+};
+const int mt_charpoly_terms = sizeof(mt_charpoly) / sizeof(mt_charpoly[0]);
+
+// p = p mod charpoly, p holds 2 * poly_words words
+// the highest lower term is 623 below mt_degree, so whole words can be reduced
+void poly_reduce(uint64_t* p) {
+  for (int w = 2 * poly_words - 1; w * 64 + 63 >= mt_degree; --w) {
+    int base = (w * 64 > mt_degree) ? w * 64 : mt_degree; // first bit to reduce
+    int shift = base - w * 64;
+    uint64_t v = p[w] >> shift;
+    if (!v) continue;
+    p[w] &= shift ? ((1ULL << shift) - 1) : 0ULL;
+    for (int t = 0; t < mt_charpoly_terms; ++t) { // x^degree = sum of the lower terms
+      int pos = base - mt_degree + mt_charpoly[t];
+      int q = pos >> 6, s = pos & 63;
+      p[q] ^= v << s;
+      if (s) p[q + 1] ^= v >> (64 - s);
+    }
+  }
+}
+
+// spread the 32 low bits of x to the even bits, squaring over GF(2)
+inline uint64_t poly_spread(uint64_t x) {
+  x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+  x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+  x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  x = (x | (x << 2)) & 0x3333333333333333ULL;
+  return (x | (x << 1)) & 0x5555555555555555ULL;
+}
+
+void poly_square(uint64_t* p) { // p = p * p mod charpoly
+  for (int w = poly_words - 1; w >= 0; --w) { // from the top, so nothing is overwritten early
+    uint64_t v = p[w];
+    p[2 * w + 1] = poly_spread(v >> 32);
+    p[2 * w] = poly_spread(v & 0xFFFFFFFFULL);
+  }
+  poly_reduce(p);
+}
+
+void poly_mul_x(uint64_t* p) { // p = p * x mod charpoly
+  for (int w = poly_words; w > 0; --w) p[w] = (p[w] << 1) | (p[w - 1] >> 63);
+  p[0] <<= 1;
+  poly_reduce(p);
+}
+
+} // namespace
 
 void MTRand_int32::gen_state() { // generate new state vector
   for (int i = 0; i < (n - m); ++i)
@@ -18,14 +85,36 @@ void MTRand_int32::gen_state() { // generate new state vector
   p = 0; // reset position
 }
 
+void MTRand_int32::fill_u32(uint32_t* out, int count) { // bulk 32 bit integers
+  while (count > 0) {
+    if (p == n) gen_state(); // new state vector needed
+    int run = n - p; // words left in the current state vector
+    if (run > count) run = count;
+    const uint32_t* s = state + p;
+    for (int i = 0; i < run; ++i) out[i] = temper(s[i]);
+    p += run; out += run; count -= run;
+  }
+}
+
+void MTRand_int32::fill_scaled(float* out, int count, int shift, float offset, float scale) {
+  while (count > 0) {
+    if (p == n) gen_state(); // new state vector needed
+    int run = n - p; // words left in the current state vector
+    if (run > count) run = count;
+    const uint32_t* s = state + p;
+    for (int i = 0; i < run; ++i)
+      out[i] = (static_cast<float>(static_cast<int32_t>(temper(s[i]) >> shift)) + offset) * scale;
+    p += run; out += run; count -= run;
+  }
+}
+
 void MTRand_int32::seed(unsigned long s) {  // init by 32 bit seed
-  state[0] = s & 0xFFFFFFFFUL; // for > 32 bit machines
+  state[0] = static_cast<uint32_t>(s); // for > 32 bit machines
   for (int i = 1; i < n; ++i) {
-    state[i] = 1812433253UL * (state[i - 1] ^ (state[i - 1] >> 30)) + i;
+    state[i] = 1812433253U * (state[i - 1] ^ (state[i - 1] >> 30)) + i;
 // see Knuth TAOCP Vol2. 3rd Ed. P.106 for multiplier
 // in the previous versions, MSBs of the seed affect only MSBs of the array state
 // 2002/01/09 modified by Makoto Matsumoto
-    state[i] &= 0xFFFFFFFFUL; // for > 32 bit machines
   }
   p = n; // force gen_state() to be called for next random number
 }
@@ -34,17 +123,50 @@ void MTRand_int32::seed(const unsigned long* array, int size) { // init by array
   seed(19650218UL);
   int i = 1, j = 0;
   for (int k = ((n > size) ? n : size); k; --k) {
-    state[i] = (state[i] ^ ((state[i - 1] ^ (state[i - 1] >> 30)) * 1664525UL))
-      + array[j] + j; // non linear
-    state[i] &= 0xFFFFFFFFUL; // for > 32 bit machines
+    state[i] = (state[i] ^ ((state[i - 1] ^ (state[i - 1] >> 30)) * 1664525U))
+      + static_cast<uint32_t>(array[j]) + j; // non linear
     ++j; j %= size;
     if ((++i) == n) { state[0] = state[n - 1]; i = 1; }
   }
   for (int k = n - 1; k; --k) {
-    state[i] = (state[i] ^ ((state[i - 1] ^ (state[i - 1] >> 30)) * 1566083941UL)) - i;
-    state[i] &= 0xFFFFFFFFUL; // for > 32 bit machines
+    state[i] = (state[i] ^ ((state[i - 1] ^ (state[i - 1] >> 30)) * 1566083941U)) - i;
     if ((++i) == n) { state[0] = state[n - 1]; i = 1; }
   }
-  state[0] = 0x80000000UL; // MSB is 1; assuring non-zero initial array
+  state[0] = 0x80000000U; // MSB is 1; assuring non-zero initial array
   p = n; // force gen_state() to be called for next random number
-}
\ No newline at end of file
+}
+void MTRand_int32::jump_ahead(unsigned long i, int k) { // skip i * 2^k numbers
+// the jump polynomial x^(i * 2^k) mod charpoly, as (x^i)^(2^k)
+  uint64_t poly[2 * poly_words];
+  memset(poly, 0, sizeof(poly));
+  poly[0] = 1;
+  for (int bit = 8 * static_cast<int>(sizeof(i)) - 1; bit >= 0; --bit) {
+    poly_square(poly);
+    if ((i >> bit) & 1UL) poly_mul_x(poly);
+  }
+  for (int j = 0; j < k; ++j) poly_square(poly);
+// evaluate it at the state transition: the state vector is seen as a window
+// of the last n words of the sequence, stepped one word at a time, and the
+// windows for the set coefficients are added up. Only the top bit of the
+// oldest word is part of the state, which is why p must not be 0 here
+  uint32_t window[n], work[n];
+  memcpy(window, state, sizeof(window));
+  memset(work, 0, sizeof(work));
+  int w0 = 0; // oldest word of the window
+  for (int d = 0; d < mt_degree; ++d) {
+    if ((poly[d >> 6] >> (d & 63)) & 1ULL) {
+      for (int j = 0; j < n - w0; ++j) work[j] ^= window[w0 + j];
+      for (int j = n - w0; j < n; ++j) work[j] ^= window[j - (n - w0)];
+    }
+    int w1 = (w0 + 1 == n) ? 0 : w0 + 1, wm = (w0 + m >= n) ? w0 + m - n : w0 + m;
+    window[w0] = window[wm] ^ twiddle(window[w0], window[w1]);
+    w0 = w1;
+  }
+  memcpy(state, work, sizeof(state)); // same position p in the jumped state vector
+}
+
+void MTRand_int32::split(MTRand_int32& child) {
+  memcpy(child.state, state, sizeof(state));
+  child.p = p;
+  substream(1);
+}
@@ -45,54 +45,78 @@
 #ifndef MTRAND_H
 #define MTRAND_H
 
+#include <stdint.h>
+
 class MTRand_int32 { // Mersenne Twister random number generator
 public:
-// default constructor: uses default seed only if this is the first instance
-  MTRand_int32() { if (!init) seed(5489UL); init = true; }
+// default constructor: uses the default seed
+  MTRand_int32() { seed(5489UL); }
 // constructor with 32 bit int as seed
-  MTRand_int32(unsigned long s) { seed(s); init = true; }
+  MTRand_int32(unsigned long s) { seed(s); }
 // constructor with array of size 32 bit ints as seed
-  MTRand_int32(const unsigned long* array, int size) { seed(array, size); init = true; }
+  MTRand_int32(const unsigned long* array, int size) { seed(array, size); }
 // the two seed functions
   void seed(unsigned long); // seed with 32 bit integer
   void seed(const unsigned long*, int size); // seed with array
 // overload operator() to make this a generator (functor)
   unsigned long operator()() { return rand_int32(); }
+// generate 32 bit random integer, also available from the derived classes
+  uint32_t rand_int32();
+// bulk generators: temper whole runs of the state array in one loop
+  void fill_u32(uint32_t* out, int count); // fill with 32 bit random integers
+  void fill(float* out, int count) { // fill with floats in [0, 1)
+    fill_scaled(out, count, 8, 0.f, 1.f / 16777216.f); } // divided by 2^24
+// jump ahead: skip 2^k numbers, the cost hardly depends on k (about 10 ms),
+// so call it from the constructor or the UI thread, not from the audio thread
+  void jump(int k) { jump_ahead(1UL, k); }
+// independent substreams, each 2^substream_log2 numbers long, so streams
+// handed out by substream() or split() can never overlap
+  static const int substream_log2 = 64;
+  void substream(unsigned long i) { jump_ahead(i, substream_log2); } // skip i substreams
+  void split(MTRand_int32& child); // child takes this stream, this skips to the next substream
 // 2007-02-11: made the destructor virtual; thanks "double more" for pointing this out
   virtual ~MTRand_int32() {} // destructor
-protected: // used by derived classes, otherwise not accessible; use the ()-operator
-  unsigned long rand_int32(); // generate 32 bit random integer
+protected: // used by derived classes, otherwise not accessible
+// fill with ((x >> shift) + offset) * scale; the upper bits of each tempered
+// word and the offset must add up to a float exactly (24 bits with no offset,
+// 23 bits with .5), so there is no rounding up to 1 and no branch
+  void fill_scaled(float* out, int count, int shift, float offset, float scale);
 private:
   static const int n = 624, m = 397; // compile time constants
-// the variables below are static (no duplicates can exist)
-  static unsigned long state[n]; // state vector array
-  static int p; // position in state array
-  static bool init; // true if init function is called
+// the variables below are per instance, so every generator owns its own stream
+// and instances running on different threads never share a cache line
+  uint32_t state[n]; // state vector array, 32 bit words
+  int p; // position in state array
 // private functions used to generate the pseudo random numbers
-  unsigned long twiddle(unsigned long, unsigned long); // used by gen_state()
+  uint32_t twiddle(uint32_t, uint32_t); // used by gen_state()
+  static uint32_t temper(uint32_t); // used by rand_int32() and the fill functions
   void gen_state(); // generate new state
+  void jump_ahead(unsigned long i, int k); // skip i * 2^k numbers
 // make copy constructor and assignment operator unavailable, they don't make sense
   MTRand_int32(const MTRand_int32&); // copy constructor not defined
   void operator=(const MTRand_int32&); // assignment operator not defined
 };
 
 // inline for speed, must therefore reside in header file
-inline unsigned long MTRand_int32::twiddle(unsigned long u, unsigned long v) {
-  return (((u & 0x80000000UL) | (v & 0x7FFFFFFFUL)) >> 1)
-    ^ ((v & 1UL) * 0x9908B0DFUL);
+inline uint32_t MTRand_int32::twiddle(uint32_t u, uint32_t v) {
+  return (((u & 0x80000000U) | (v & 0x7FFFFFFFU)) >> 1)
+    ^ ((v & 1U) * 0x9908B0DFU);
 // 2013-07-22: line above modified for performance according to http://www.math.sci.hiroshima-u.ac.jp/~m-mat/MT/Ierymenko.html
 // thanks Vitaliy FEOKTISTOV for pointing this out
 }
 
-inline unsigned long MTRand_int32::rand_int32() { // generate 32 bit random int
+inline uint32_t MTRand_int32::temper(uint32_t x) {
+  x ^= (x >> 11);
+  x ^= (x << 7) & 0x9D2C5680U;
+  x ^= (x << 15) & 0xEFC60000U;
+  return x ^ (x >> 18);
+}
+
+inline uint32_t MTRand_int32::rand_int32() { // generate 32 bit random int
   if (p == n) gen_state(); // new state vector needed
 // gen_state() is split off to be non-inline, because it is only called once
 // in every 624 calls and otherwise irand() would become too big to get inlined
-  unsigned long x = state[p++];
-  x ^= (x >> 11);
-  x ^= (x << 7) & 0x9D2C5680UL;
-  x ^= (x << 15) & 0xEFC60000UL;
-  return x ^ (x >> 18);
+  return temper(state[p++]);
 }
 
 // generates double floating point numbers in the half-open interval [0, 1)
@@ -118,6 +142,8 @@ public:
   ~MTRand_closed() {}
   double operator()() {
     return static_cast<double>(rand_int32()) * (1. / 4294967295.); } // divided by 2^32 - 1
+  void fill(float* out, int count) {
+    fill_scaled(out, count, 8, 0.f, 1.f / 16777215.f); } // divided by 2^24 - 1
 private:
   MTRand_closed(const MTRand_closed&); // copy constructor not defined
   void operator=(const MTRand_closed&); // assignment operator not defined
@@ -132,6 +158,12 @@ public:
   ~MTRand_open() {}
   double operator()() {
     return (static_cast<double>(rand_int32()) + .5) * (1. / 4294967296.); } // divided by 2^32
+// the float of one word as fill() computes it: the upper 23 bits plus .5, so
+// the largest is 1 - 2^-24 and not rounded up to 1
+  static float to_float(uint32_t x) {
+    return (static_cast<float>(static_cast<int32_t>(x >> 9)) + .5f) * (1.f / 8388608.f); }
+  void fill(float* out, int count) {
+    fill_scaled(out, count, 9, .5f, 1.f / 8388608.f); } // divided by 2^23
 private:
   MTRand_open(const MTRand_open&); // copy constructor not defined
   void operator=(const MTRand_open&); // assignment operator not defined
@@ -0,0 +1,147 @@
+// randomsource.cpp, see include file randomsource.h for information
+
+#include "randomsource.h"
+#include <time.h>
+#include <atomic>
+#include <new>
+
+// operations passed to RandomSource::apply()
+namespace {
+
+// engine e is not alive yet, only its storage
+struct ConstructOp {
+  template <class Engine> void operator()(Engine& e) { new (&e) Engine(); }
+};
+
+struct DestroyOp {
+  template <class Engine> void operator()(Engine& e) { e.~Engine(); }
+};
+
+struct SeedOp {
+  unsigned long s;
+  template <class Engine> void operator()(Engine& e) { e.seed(s); }
+};
+
+struct SeedArrayOp {
+  const unsigned long* array;
+  int size;
+  template <class Engine> void operator()(Engine& e) { e.seed(array, size); }
+};
+
+struct RandInt32Op {
+  uint32_t result;
+  template <class Engine> void operator()(Engine& e) { result = e.rand_int32(); }
+};
+
+struct FillU32Op {
+  uint32_t* out;
+  int count;
+  template <class Engine> void operator()(Engine& e) { e.fill_u32(out, count); }
+};
+
+struct FillOp {
+  float* out;
+  int count;
+  template <class Engine> void operator()(Engine& e) { e.fill(out, count); }
+};
+
+// the streams of the process all start from one key, made from the time and
+// the address of the stream counter, and are told apart by their numbers
+std::atomic<uint64_t> streamCount(0);
+
+uint64_t processKey() {
+  static const uint64_t key = static_cast<uint64_t>(time(NULL)) * 0xD1B54A32D192ED03ULL ^
+    static_cast<uint64_t>(reinterpret_cast<uintptr_t>(&streamCount));
+  return key;
+}
+
+// the engine at substream sub of stream, see RandomSource::seedStream()
+struct StreamOp {
+  uint64_t stream;
+  int sub;
+  uint64_t index() const { return stream * RANDOM_SUBSTREAMS + static_cast<uint64_t>(sub); }
+  template <class Engine> void seedKey(Engine& e) {
+    unsigned long key[2] = { static_cast<uint32_t>(processKey()),
+      static_cast<uint32_t>(processKey() >> 32) };
+    e.seed(key, 2);
+  }
+  void operator()(MTRand& e) { seedKey(e); e.substream(static_cast<unsigned long>(index())); }
+  void operator()(SFMTRand& e) { seedKey(e); e.substream(static_cast<unsigned long>(index())); }
+  void operator()(Xoshiro128Plus& e) {
+    e.seed64(processKey());
+    for (uint64_t k = 0; k < stream; ++k) e.long_jump();
+    for (int k = 0; k < sub; ++k) e.jump();
+  }
+  void operator()(Xoshiro256StarStar& e) {
+    e.seed64(processKey());
+    for (uint64_t k = 0; k < stream; ++k) e.long_jump();
+    for (int k = 0; k < sub; ++k) e.jump();
+  }
+  void operator()(Pcg32& e) { e.seed64(processKey()); e.advance(index() << 40); }
+  void operator()(SplitMix64& e) { e.seed64(processKey()); e.advance(index() << 40); }
+  void operator()(Philox4x32& e) { e.seed64(processKey()); e.setStream(index()); }
+};
+
+} // namespace
+
+void RandomSource::construct() {
+  ConstructOp op;
+  apply(op);
+}
+
+void RandomSource::destroy() {
+  DestroyOp op;
+  apply(op);
+}
+
+void RandomSource::seed(unsigned long s) {
+  SeedOp op = { s };
+  apply(op);
+}
+
+void RandomSource::seed(const unsigned long* array, int size) {
+  SeedArrayOp op = { array, size };
+  apply(op);
+}
+
+uint64_t RandomSource::newStream() {
+  return streamCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RandomSource::seedStream(uint64_t stream, int sub) {
+  StreamOp op = { stream, sub };
+  apply(op);
+}
+
+void RandomSource::seedUnique() {
+  seedStream(newStream(), 0);
+}
+
+int RandomSource::setEngine(int newEngine) {
+  int oldEngine = engineType;
+  if (newEngine >= 0 && newEngine < NUM_ENGINES && newEngine != oldEngine) {
+    unsigned long key[4];
+    for (int k = 0; k < 4; ++k) key[k] = rand_int32();
+    destroy();
+    engineType = newEngine;
+    construct();
+    seed(key, 4);
+  }
+  return oldEngine;
+}
+
+uint32_t RandomSource::rand_int32() {
+  RandInt32Op op;
+  apply(op);
+  return op.result;
+}
+
+void RandomSource::fill_u32(uint32_t* out, int count) {
+  FillU32Op op = { out, count };
+  apply(op);
+}
+
+void RandomSource::fill(float* out, int count) {
+  FillOp op = { out, count };
+  apply(op);
+}
@@ -0,0 +1,395 @@
+// sfmtrand.cpp, see include file sfmtrand.h for information
+
+#include "sfmtrand.h"
+#include <string.h>
+#ifdef SFMT_SSE2
+  #include <emmintrin.h>
+#endif
+
+// SFMT19937 parameters
+static const int sfmt_pos1 = 122; // pick up position of the array
+static const int sfmt_sl1 = 18; // shift left of each 32 bit word
+static const int sfmt_sl2 = 1; // shift left of the 128 bit word, in bytes
+static const int sfmt_sr1 = 11; // shift right of each 32 bit word
+static const int sfmt_sr2 = 1; // shift right of the 128 bit word, in bytes
+static const uint32_t sfmt_msk[4] = { 0xdfffffefU, 0xddfecb7fU, 0xbffaffffU, 0xbffffff6U };
+static const uint32_t sfmt_parity[4] = { 0x00000001U, 0x00000000U, 0x00000000U, 0x13c9e684U };
+
+#ifdef SFMT_SSE2
+
+// one step of the recursion on four 32 bit words at once
+static inline __m128i sfmt_recursion(__m128i a, __m128i b, __m128i c, __m128i d, __m128i mask) {
+  __m128i x = _mm_slli_si128(a, sfmt_sl2);
+  __m128i y = _mm_and_si128(_mm_srli_epi32(b, sfmt_sr1), mask);
+  __m128i z = _mm_srli_si128(c, sfmt_sr2);
+  __m128i v = _mm_slli_epi32(d, sfmt_sl1);
+  z = _mm_xor_si128(z, a);
+  z = _mm_xor_si128(z, v);
+  z = _mm_xor_si128(z, x);
+  return _mm_xor_si128(z, y);
+}
+
+// the same step on words in memory, as the scalar version, r may alias a
+static inline void sfmt_recursion(uint32_t* r, const uint32_t* a, const uint32_t* b,
+  const uint32_t* c, const uint32_t* d) {
+  const __m128i mask = _mm_set_epi32(sfmt_msk[3], sfmt_msk[2], sfmt_msk[1], sfmt_msk[0]);
+  __m128i v = sfmt_recursion(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a)),
+    _mm_loadu_si128(reinterpret_cast<const __m128i*>(b)),
+    _mm_loadu_si128(reinterpret_cast<const __m128i*>(c)),
+    _mm_loadu_si128(reinterpret_cast<const __m128i*>(d)), mask);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(r), v);
+}
+
+void SFMTRand::gen_state() { // generate new state vector
+  __m128i* s = reinterpret_cast<__m128i*>(state);
+  const __m128i mask = _mm_set_epi32(sfmt_msk[3], sfmt_msk[2], sfmt_msk[1], sfmt_msk[0]);
+  __m128i r1 = _mm_loadu_si128(s + n - 2);
+  __m128i r2 = _mm_loadu_si128(s + n - 1);
+  int i = 0;
+  for (; i < n - sfmt_pos1; ++i) {
+    __m128i r = sfmt_recursion(_mm_loadu_si128(s + i), _mm_loadu_si128(s + i + sfmt_pos1), r1, r2, mask);
+    _mm_storeu_si128(s + i, r);
+    r1 = r2; r2 = r;
+  }
+  for (; i < n; ++i) {
+    __m128i r = sfmt_recursion(_mm_loadu_si128(s + i), _mm_loadu_si128(s + i + sfmt_pos1 - n), r1, r2, mask);
+    _mm_storeu_si128(s + i, r);
+    r1 = r2; r2 = r;
+  }
+  p = 0; // reset position
+}
+
+#else
+
+// 128 bit shifts of four 32 bit words, by a number of bytes
+static inline void sfmt_rshift128(uint32_t* out, const uint32_t* in, int shift) {
+  uint64_t th = (static_cast<uint64_t>(in[3]) << 32) | in[2];
+  uint64_t tl = (static_cast<uint64_t>(in[1]) << 32) | in[0];
+  uint64_t oh = th >> (shift * 8);
+  uint64_t ol = (tl >> (shift * 8)) | (th << (64 - shift * 8));
+  out[0] = static_cast<uint32_t>(ol); out[1] = static_cast<uint32_t>(ol >> 32);
+  out[2] = static_cast<uint32_t>(oh); out[3] = static_cast<uint32_t>(oh >> 32);
+}
+
+static inline void sfmt_lshift128(uint32_t* out, const uint32_t* in, int shift) {
+  uint64_t th = (static_cast<uint64_t>(in[3]) << 32) | in[2];
+  uint64_t tl = (static_cast<uint64_t>(in[1]) << 32) | in[0];
+  uint64_t oh = (th << (shift * 8)) | (tl >> (64 - shift * 8));
+  uint64_t ol = tl << (shift * 8);
+  out[0] = static_cast<uint32_t>(ol); out[1] = static_cast<uint32_t>(ol >> 32);
+  out[2] = static_cast<uint32_t>(oh); out[3] = static_cast<uint32_t>(oh >> 32);
+}
+
+// one step of the recursion, r may alias a
+static inline void sfmt_recursion(uint32_t* r, const uint32_t* a, const uint32_t* b,
+  const uint32_t* c, const uint32_t* d) {
+  uint32_t x[4], y[4];
+  sfmt_lshift128(x, a, sfmt_sl2);
+  sfmt_rshift128(y, c, sfmt_sr2);
+  for (int k = 0; k < 4; ++k)
+    r[k] = a[k] ^ x[k] ^ ((b[k] >> sfmt_sr1) & sfmt_msk[k]) ^ y[k] ^ (d[k] << sfmt_sl1);
+}
+
+void SFMTRand::gen_state() { // generate new state vector
+  const uint32_t* r1 = state + (n - 2) * 4;
+  const uint32_t* r2 = state + (n - 1) * 4;
+  int i = 0;
+  for (; i < n - sfmt_pos1; ++i) {
+    sfmt_recursion(state + i * 4, state + i * 4, state + (i + sfmt_pos1) * 4, r1, r2);
+    r1 = r2; r2 = state + i * 4;
+  }
+  for (; i < n; ++i) {
+    sfmt_recursion(state + i * 4, state + i * 4, state + (i + sfmt_pos1 - n) * 4, r1, r2);
+    r1 = r2; r2 = state + i * 4;
+  }
+  p = 0; // reset position
+}
+
+#endif // SFMT_SSE2
+
+void SFMTRand::fill_u32(uint32_t* out, int count) { // bulk 32 bit integers
+  while (count > 0) {
+    if (p == n32) gen_state(); // new state vector needed
+    int run = n32 - p; // words left in the current state vector
+    if (run > count) run = count;
+    memcpy(out, state + p, run * sizeof(uint32_t));
+    p += run; out += run; count -= run;
+  }
+}
+
+void SFMTRand::fill(float* out, int count) { // bulk floats in [0, 1)
+  while (count > 0) {
+    if (p == n32) gen_state(); // new state vector needed
+    int run = n32 - p; // words left in the current state vector
+    if (run > count) run = count;
+    const uint32_t* s = state + p;
+    for (int i = 0; i < run; ++i) // upper 24 bits, exact and branch free
+      out[i] = static_cast<float>(static_cast<int32_t>(s[i] >> 8)) * (1.f / 16777216.f);
+    p += run; out += run; count -= run;
+  }
+}
+
+// polynomial arithmetic over GF(2) used by substream(), as in mtrand.cpp: a
+// polynomial is an array of 64 bit words with the coefficient of x^i in bit i.
+// The transition is the step of one 128 bit word, whose characteristic
+// polynomial, unlike MT19937's, has terms everywhere below its degree
+namespace {
+
+const int sfmt_degree = 19968; // degree of the characteristic polynomial
+const int poly_words = sfmt_degree / 64; // words of a reduced polynomial
+
+// the terms below sfmt_degree of the characteristic polynomial of the SFMT19937
+// transition, found with the Berlekamp-Massey algorithm on the generator output
+const uint64_t sfmt_charpoly[poly_words] = {
+  0x0000000000000001ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+  0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+  0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+  0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+  0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+  0x0000000000000000ULL, 0x0000000000020000ULL, 0x0000000000000000ULL,
+  0x0000280000000000ULL, 0x0000100000010000ULL, 0x0000000000000000ULL,
+  0x00000000000000a0ULL, 0x0000000000000140ULL, 0x0000000a00000000ULL,
+  0x1100001400000000ULL, 0x8200000000000000ULL, 0x0000000000200000ULL,
+  0x0000000000540001ULL, 0x0000800008280000ULL, 0x0011400000000000ULL,
+  0x00a0800000000000ULL, 0x0000400000000000ULL, 0x0000000400000040ULL,
+  0x00000088000a0800ULL, 0x1000004400000500ULL, 0x000080a000000200ULL,
+  0x4400001400000020ULL, 0x0000002004400010ULL, 0x5008800108000808ULL,
+  0x0010000105500001ULL, 0x000200a0a2200002ULL, 0x0441000011008200ULL,
+  0x0802804020810400ULL, 0x011100880008000aULL, 0x000a040001054100ULL,
+  0x2020000082a20805ULL, 0x400040500015140aULL, 0x8820000810002804ULL,
+  0x0009415808808808ULL, 0xa00102a400010500ULL, 0xc2800000a0a0202aULL,
+  0x000404440002d011ULL, 0x0a8200020ad444a2ULL, 0x0111040115028080ULL,
+  0x028c170826050105ULL, 0x1512280000828020ULL, 0x4220144044141282ULL,
+  0x8008200044880c20ULL, 0x04d0501029419208ULL, 0x2260a9a201342400ULL,
+  0x42b011808200a0a0ULL, 0x6043668044470047ULL, 0x02800a0280028a42ULL,
+  0x101448840d038108ULL, 0x8a0249858605200fULL, 0x0614be1144282080ULL,
+  0x982846067854480eULL, 0x005aa00480a040d4ULL, 0x24915400e1456171ULL,
+  0x41a8002841a1a172ULL, 0x8236063b70e58020ULL, 0x045a0e4302c2c14eULL,
+  0x1e1281a00c8a020eULL, 0x363f214518ba8948ULL, 0x0271812261458186ULL,
+  0x1cc00e4401222930ULL, 0x2854d800a7263278ULL, 0x68b8aa40a02c9855ULL,
+  0x0373450904111bdcULL, 0x2600f3a0602350a0ULL, 0x644f4c31b0bb80a5ULL,
+  0xd20a1d4608ef2560ULL, 0x8a0b4b9211312406ULL, 0x82ae7517009f9982ULL,
+  0x601756539a200074ULL, 0x640a70122436867cULL, 0x8020484dc862a715ULL,
+  0xe2e2e81b48d8b424ULL, 0x72b122c30548ac38ULL, 0xd2a3870790381012ULL,
+  0xcb56e0eece1c70b7ULL, 0x3502990347470682ULL, 0xa8601f8b5c7411e1ULL,
+  0x3775a12a833a30b5ULL, 0x052143a0016f9a44ULL, 0xce3b6a1212780c22ULL,
+  0xc05c5070c11b954eULL, 0xa6b0b13223bc8d00ULL, 0x26110291d7d998c0ULL,
+  0x2097e7a161246d50ULL, 0x8d4d25c4574d475cULL, 0x152e14187c8b1e6bULL,
+  0xda950b3fcb88e537ULL, 0x835944751836d521ULL, 0x2636a40253002240ULL,
+  0xffef9c51964912a5ULL, 0x7d4964adc523308cULL, 0x69f98f32aa726ab9ULL,
+  0x47130b37425091ddULL, 0x401ab0ff24e21061ULL, 0x9453c512e050cd4bULL,
+  0x1ac684510d88fa5fULL, 0xa16ca218b2933017ULL, 0x5424cd6cea03afbaULL,
+  0x3df8a93b3b286b75ULL, 0x32873ba3471bc681ULL, 0x5b798315ecd48145ULL,
+  0xb45a9468ba2e3b9eULL, 0xd571d4457ecae4b2ULL, 0xc9d63e3bd3bbfa43ULL,
+  0x192bea7fa9441ce2ULL, 0x79b6d1bcc6cfa705ULL, 0xd63fc57efa82ca0bULL,
+  0xc839574ca64d7f35ULL, 0xecf5868d70ee9058ULL, 0x29f4a75568cf95dbULL,
+  0x67a6382493eac127ULL, 0xd196437f9f4a71cbULL, 0x1b3022c27d461c7fULL,
+  0xa6a567ce4085d0bcULL, 0xae311af7b7278a1eULL, 0xa48c600294a94bfcULL,
+  0xd624ca7a2f95b256ULL, 0x560241615d847f18ULL, 0xc6371879a520d42cULL,
+  0xd08d5f07d17e3abdULL, 0x3df9d3be7ad73124ULL, 0xc33686612cb4cbfaULL,
+  0x2dbe79740e8090c0ULL, 0x30a4a80f6d4c79ecULL, 0x5519d7912ce7f435ULL,
+  0xc764fa909d0b2688ULL, 0x27c655cfecc233f7ULL, 0xe85987a8af20a5f9ULL,
+  0xd411bc7314c8d5dcULL, 0x93899b016b45a3f0ULL, 0x61f5d113c20b0df0ULL,
+  0xb25da61e4a096903ULL, 0x0dbe028d6d3567afULL, 0x9fa2ffe90c694a8bULL,
+  0xddbc8fc13fbb001bULL, 0xd4f0394b007675b1ULL, 0x82a77db81439b4c5ULL,
+  0xe3926b17cba15b02ULL, 0x8c9459c774f90065ULL, 0xc96951bd97a7280dULL,
+  0xd05abe912bca7f94ULL, 0x60711d1a815f1c57ULL, 0x042d25ce0d6cfd66ULL,
+  0xe26807fc63178c4fULL, 0x7ce8a197b575c993ULL, 0x40b7cd97348c4e6eULL,
+  0x4121abca0b44faf6ULL, 0xe52018057e436e7cULL, 0xeee29d71348ff820ULL,
+  0x5897af73be049411ULL, 0x0a6fdc8a2abfe601ULL, 0x9927489f06e9acb9ULL,
+  0x212a9e204d2b3555ULL, 0x726f34b152c7e23bULL, 0xba18032b9081e787ULL,
+  0x1e6fd7621f8d4fceULL, 0xddc1ca0a680b74f2ULL, 0x0b73fbbb3926fb78ULL,
+  0x99f11bf5fbcb7c8cULL, 0xfa95b50d32e55b88ULL, 0x898481c3f32feb9fULL,
+  0x0c5530801a0da142ULL, 0xe8d7a917f97df770ULL, 0x4875f816a8423596ULL,
+  0xdbb428b030a50aa9ULL, 0x0e3950a4612c5231ULL, 0xe3e8182323c04d1dULL,
+  0x391f65dd70a31febULL, 0xd0037d2ea87036c2ULL, 0x585cb2a68d024115ULL,
+  0x3ca80652b82e08daULL, 0x1222a69b8994a108ULL, 0x4de6d9cdceae67bcULL,
+  0xddca8edabd55bf58ULL, 0xf6a0757e4667e48eULL, 0x9b32d9f9b71a27e7ULL,
+  0x40f2769f8f20f8f8ULL, 0x45043e807c88737fULL, 0xb8ee0dd038f6f4afULL,
+  0x1484c5e77d62c435ULL, 0x8dd2569dfa4d9131ULL, 0x5f523ec999db3861ULL,
+  0x3418fa6737e8b00dULL, 0x269f5801674ff9a5ULL, 0x0cd977b54925f868ULL,
+  0x0efe2aca2f5aac13ULL, 0x56317da6a2f6b8c4ULL, 0xe534d38250fa24ddULL,
+  0xdfa8dc9afeb39524ULL, 0xf68b95bdbfe9f66fULL, 0xcd69cc6772132bd7ULL,
+  0xb5b4dfded98e8544ULL, 0x0387409dcb87d8d7ULL, 0x8f0023832ffcb147ULL,
+  0x2765011aafc4140fULL, 0x83081b652eca2bddULL, 0x4d14a10e4b5b0ac3ULL,
+  0x7c88af6e819ec2c9ULL, 0x0e191e6f25748090ULL, 0xd6495ebd110a22f4ULL,
+  0xdbf1f3cefb3cbcdfULL, 0x9448bef759c292caULL, 0xa5634a3ae4d4acfbULL,
+  0x7164a8c8c26ad6a4ULL, 0x965e5a7cfb55c640ULL, 0xdcf519a0992e424eULL,
+  0x8f610efdff342da1ULL, 0xf9242248af2415d8ULL, 0x10c4b695164603b8ULL,
+  0x1e87d6082fa1757bULL, 0x7a57a7a99015387cULL, 0x286a730fd18197c4ULL,
+  0x337303598db3d5d7ULL, 0xfec20b20ffa6cb03ULL, 0x420ebf29112f2932ULL,
+  0x854a5d8b53939260ULL, 0xcb1a14d9f27695a2ULL, 0x70d1a3a726ac668eULL,
+  0xf1b6da4284c007a7ULL, 0x72a04fdc5cb3134eULL, 0x2a3d847fe51d6b08ULL,
+  0x3b3b804a91cea167ULL, 0xc59263aa363cac3bULL, 0x034e799408af0885ULL,
+  0x006262ed52a6fa26ULL, 0xe0acc024778a11e8ULL, 0xcd4d4ab18447afcaULL,
+  0x576f160423a6c70cULL, 0x10631e8624500040ULL, 0x02221f668cc007feULL,
+  0x4b061c0105120745ULL, 0x2b15ed7d4b520260ULL, 0x20410d99d63883d1ULL,
+  0xe3375e48c3b54b20ULL, 0xcc86a05034ecdea6ULL, 0xced1542ae91014a1ULL,
+  0x622980024f61246eULL, 0x08b013659c68f806ULL, 0xf5909002f128b242ULL,
+  0x67d3234a7a8458beULL, 0x201ac293eeaa9176ULL, 0x0cb848026d5fa140ULL,
+  0x5c02883711114816ULL, 0x1c518a7c4631ec3aULL, 0x164ab085407e6130ULL,
+  0x00609822b1288189ULL, 0x420e03588aad0882ULL, 0xa0558040a144a900ULL,
+  0x0054b1a8b0022848ULL, 0x0a974810486c5464ULL, 0x20406990422a4880ULL,
+  0x04201d5a0c864f08ULL, 0x00a14580208b518bULL, 0x2020d0b080740015ULL,
+  0xc000b3323000a400ULL, 0x13011049400a9948ULL, 0x8348220c6a884c49ULL,
+  0x91500a5781080941ULL, 0x16a001b492002140ULL, 0x00a480923051a804ULL,
+  0x1b11001460854081ULL, 0x010442001c20810aULL, 0x001a4d8101a30803ULL,
+  0x4552001182b32021ULL, 0x900000c8b61000a0ULL, 0x4831008010402074ULL,
+  0xa9d1000a00180808ULL, 0x2040020c42038108ULL, 0x80400040a0a03122ULL,
+  0x448808048a111020ULL, 0x0e8a1110001440a0ULL, 0x0889100200080804ULL,
+  0x2201120805400101ULL, 0x2000000040888030ULL, 0x0450880048841500ULL,
+  0x0408801100800028ULL, 0x00a8414002010808ULL, 0x2220010280560201ULL,
+  0x000000020000a804ULL, 0x20050080000a0050ULL, 0x01000a0000000000ULL,
+  0x1100800400000008ULL, 0x0022000000004020ULL, 0x0000000000100080ULL,
+  0x0000000000000004ULL, 0x0800000000000000ULL, 0x0010000040000000ULL,
+  0x0000200000000002ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+  0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+  0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+};
+
+// p = p mod charpoly, p holds 2 * poly_words words; the degree is a whole
+// number of words, and reducing a bit only changes the bits below it
+void poly_reduce(uint64_t* p) {
+  for (int w = 2 * poly_words - 1; w >= poly_words; --w) {
+    while (p[w]) {
+      int b = 63;
+      while (!((p[w] >> b) & 1ULL)) --b;
+      p[w] ^= 1ULL << b; // x^(64 w + b) = x^(64 (w - poly_words) + b) * lower terms
+      uint64_t* q = p + (w - poly_words);
+      if (b) {
+        q[0] ^= sfmt_charpoly[0] << b;
+        for (int k = 1; k < poly_words; ++k)
+          q[k] ^= (sfmt_charpoly[k] << b) | (sfmt_charpoly[k - 1] >> (64 - b));
+        q[poly_words] ^= sfmt_charpoly[poly_words - 1] >> (64 - b);
+      } else {
+        for (int k = 0; k < poly_words; ++k) q[k] ^= sfmt_charpoly[k];
+      }
+    }
+  }
+}
+
+// spread the 32 low bits of x to the even bits, squaring over GF(2)
+inline uint64_t poly_spread(uint64_t x) {
+  x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+  x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+  x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  x = (x | (x << 2)) & 0x3333333333333333ULL;
+  return (x | (x << 1)) & 0x5555555555555555ULL;
+}
+
+void poly_square(uint64_t* p) { // p = p * p mod charpoly
+  for (int w = poly_words - 1; w >= 0; --w) { // from the top, so nothing is overwritten early
+    uint64_t v = p[w];
+    p[2 * w + 1] = poly_spread(v >> 32);
+    p[2 * w] = poly_spread(v & 0xFFFFFFFFULL);
+  }
+  poly_reduce(p);
+}
+
+// x^(2^(substream_log2 - 2 + j)) mod charpoly for j < 32, the jump by 2^j
+// substreams in 128 bit words; built by the first substream() call
+struct SubstreamJumps {
+  uint64_t poly[32][poly_words];
+  SubstreamJumps() {
+    uint64_t p[2 * poly_words];
+    memset(p, 0, sizeof(p));
+    p[0] = 2; // x
+    for (int k = 0; k < SFMTRand::substream_log2 - 2; ++k) poly_square(p);
+    for (int j = 0; j < 32; ++j) {
+      memcpy(poly[j], p, sizeof(poly[j]));
+      poly_square(p);
+    }
+  }
+};
+
+const SubstreamJumps& substreamJumps() {
+  static const SubstreamJumps jumps; // built once, also with several threads
+  return jumps;
+}
+
+} // namespace
+
+void SFMTRand::jump_ahead(const uint64_t* poly) { // apply poly(transition) to the state
+// the state vector is a window of the last n 128 bit words of the sequence,
+// stepped one word at a time, and the windows for the set coefficients are
+// added up, as in MTRand_int32::jump_ahead(); p stays where it is
+  uint32_t window[n32], work[n32];
+  memcpy(window, state, sizeof(window));
+  memset(work, 0, sizeof(work));
+  int w0 = 0; // oldest word of the window
+  for (int d = 0; d < sfmt_degree; ++d) {
+    if ((poly[d >> 6] >> (d & 63)) & 1ULL) {
+      for (int j = 0; j < 4 * (n - w0); ++j) work[j] ^= window[4 * w0 + j];
+      for (int j = 4 * (n - w0); j < n32; ++j) work[j] ^= window[j - 4 * (n - w0)];
+    }
+    int w1 = (w0 + 1 == n) ? 0 : w0 + 1;
+    int wb = (w0 + sfmt_pos1 >= n) ? w0 + sfmt_pos1 - n : w0 + sfmt_pos1;
+    int wc = (w0 + n - 2 >= n) ? w0 - 2 : w0 + n - 2;
+    int wd = (w0 + n - 1 >= n) ? w0 - 1 : w0 + n - 1;
+    sfmt_recursion(window + 4 * w0, window + 4 * w0, window + 4 * wb, window + 4 * wc, window + 4 * wd);
+    w0 = w1;
+  }
+  memcpy(state, work, sizeof(state));
+}
+
+void SFMTRand::substream(unsigned long i) { // skip i substreams
+  const SubstreamJumps& jumps = substreamJumps();
+  for (int j = 0; j < 32; ++j)
+    if ((i >> j) & 1UL) jump_ahead(jumps.poly[j]);
+}
+
+void SFMTRand::period_certification() {
+  uint32_t inner = 0;
+  for (int i = 0; i < 4; ++i) inner ^= state[i] & sfmt_parity[i];
+  for (int i = 16; i > 0; i >>= 1) inner ^= inner >> i;
+  if (inner & 1) return; // period is already 2^19937 - 1
+  for (int i = 0; i < 4; ++i) { // otherwise flip the lowest parity bit
+    uint32_t work = 1;
+    for (int j = 0; j < 32; ++j) {
+      if (work & sfmt_parity[i]) { state[i] ^= work; return; }
+      work <<= 1;
+    }
+  }
+}
+
+void SFMTRand::seed(unsigned long s) { // init by 32 bit seed
+  state[0] = static_cast<uint32_t>(s); // for > 32 bit machines
+  for (int i = 1; i < n32; ++i)
+    state[i] = 1812433253U * (state[i - 1] ^ (state[i - 1] >> 30)) + i;
+  p = n32; // force gen_state() to be called for next random number
+  period_certification();
+}
+
+void SFMTRand::seed(const unsigned long* array, int size) { // init by array
+  const int lag = 11, mid = (n32 - lag) / 2;
+  memset(state, 0x8b, sizeof(state));
+  int count = (size + 1 > n32) ? size + 1 : n32;
+  uint32_t r = state[0] ^ state[mid] ^ state[n32 - 1];
+  r = (r ^ (r >> 27)) * 1664525U;
+  state[mid] += r;
+  r += size;
+  state[mid + lag] += r;
+  state[0] = r;
+  --count;
+  int i = 1, j = 0;
+  for (; j < count; ++j) {
+    r = state[i] ^ state[(i + mid) % n32] ^ state[(i + n32 - 1) % n32];
+    r = (r ^ (r >> 27)) * 1664525U;
+    state[(i + mid) % n32] += r;
+    r += (j < size ? static_cast<uint32_t>(array[j]) : 0U) + i;
+    state[(i + mid + lag) % n32] += r;
+    state[i] = r;
+    i = (i + 1) % n32;
+  }
+  for (j = 0; j < n32; ++j) {
+    r = state[i] + state[(i + mid) % n32] + state[(i + n32 - 1) % n32];
+    r = (r ^ (r >> 27)) * 1566083941U;
+    state[(i + mid) % n32] ^= r;
+    r -= i;
+    state[(i + mid + lag) % n32] ^= r;
+    state[i] = r;
+    i = (i + 1) % n32;
+  }
+  p = n32; // force gen_state() to be called for next random number
+  period_certification();
+}
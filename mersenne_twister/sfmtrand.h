@@ -0,0 +1,108 @@
+// sfmtrand.h
+// C++ include file for SFMT19937, the SIMD-oriented Fast Mersenne Twister
+// by Mutsuo Saito and Makoto Matsumoto, Hiroshima University, 2006-2007.
+// http://www.math.sci.hiroshima-u.ac.jp/~m-mat/MT/SFMT/
+// Adapted to the interface of mtrand.h so both generators can be swapped.
+//
+// Copyright (c) 2006,2007 Mutsuo Saito, Makoto Matsumoto and Hiroshima
+// University. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of the Hiroshima University nor the names of
+//       its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written
+//       permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// SFMT works on 128 bit words, so the whole state vector is regenerated with
+// one SSE2 recursion per 4 output words instead of one scalar twiddle per
+// word, and the output needs no tempering. Each 128 bit word depends on the
+// two words generated just before it, so wider registers (AVX2) do not help
+// the recursion itself; the float conversion in fill() is a plain loop the
+// compiler vectorizes at whatever width is enabled.
+// A scalar version of the recursion is used when SSE2 is not available, it
+// produces exactly the same sequence.
+//
+// Throughput measured against the MT19937 code in mtrand.h (gcc -O2, x86-64,
+// 1e8 words in blocks of 512, best of several runs):
+//   MTRand_int32 operator()             ~ 3.1 ns/word
+//   MTRand_int32::fill_u32()            ~ 2.8 ns/word
+//   SFMTRand::fill_u32() SSE2 / scalar  ~ 0.5 / 2.8 ns/word  (about 5.5x)
+//   (float)MTRand operator()            ~ 5.2 ns/sample
+//   MTRand::fill()                      ~ 3.5 ns/sample
+//   SFMTRand::fill() SSE2               ~ 1.5 ns/sample      (about 3.5x)
+
+#ifndef SFMTRAND_H
+#define SFMTRAND_H
+
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define SFMT_SSE2
+#endif
+
+class SFMTRand { // SIMD-oriented Fast Mersenne Twister, period 2^19937 - 1
+public:
+// default constructor: uses the default seed
+  SFMTRand() { seed(5489UL); }
+// constructor with 32 bit int as seed
+  SFMTRand(unsigned long s) { seed(s); }
+// constructor with array of size 32 bit ints as seed
+  SFMTRand(const unsigned long* array, int size) { seed(array, size); }
+  ~SFMTRand() {}
+// the two seed functions, same as MTRand_int32
+  void seed(unsigned long); // seed with 32 bit integer
+  void seed(const unsigned long*, int size); // seed with array
+// generates double floating point numbers in the half-open interval [0, 1)
+  double operator()() {
+    return static_cast<double>(rand_int32()) * (1. / 4294967296.); } // divided by 2^32
+// generate 32 bit random integer
+  uint32_t rand_int32() {
+    if (p == n32) gen_state(); // new state vector needed
+    return state[p++];
+  }
+// bulk generators, same semantics as MTRand_int32::fill_u32() and fill()
+  void fill_u32(uint32_t* out, int count); // fill with 32 bit random integers
+  void fill(float* out, int count); // fill with floats in [0, 1)
+// independent substreams, each 2^substream_log2 numbers long as with
+// MTRand_int32, so streams handed out by substream() can never overlap.
+// substream(i) skips i of them, i < 2^32; it evaluates one jump polynomial
+// per set bit of i, each a few ms, and the first call in the process builds
+// those polynomials (about 80 KB, a few hundred ms), so call it from the
+// constructor or the UI thread, not from the audio thread
+  static const int substream_log2 = 64;
+  void substream(unsigned long i);
+private:
+  static const int n = 156, n32 = n * 4; // number of 128 bit and 32 bit words
+  uint32_t state[n32]; // state vector array, four 32 bit words per 128 bit word
+  int p; // position in state array, in 32 bit words
+// private functions used to generate the pseudo random numbers
+  void gen_state(); // generate new state
+  void period_certification(); // make sure the period is 2^19937 - 1
+  void jump_ahead(const uint64_t* poly); // apply poly(transition) to the state
+// make copy constructor and assignment operator unavailable, they don't make sense
+  SFMTRand(const SFMTRand&); // copy constructor not defined
+  void operator=(const SFMTRand&); // assignment operator not defined
+};
+
+#endif // SFMTRAND_H
@@ -0,0 +1,45 @@
+// mtrand_open_test.cpp
+// Checks that MTRand_open::fill() keeps to the open interval (0, 1).
+//
+//   g++ -O2 -I.. mtrand_open_test.cpp ../mtrand.cpp -o mtrand_open_test
+//
+// Returns 0 when every check passes.
+
+#include "mtrand.h"
+#include <stdio.h>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+  if (!ok) {
+    printf("FAILED: %s\n", what);
+    ++failures;
+  }
+}
+
+int main() {
+// the extreme words, which fill() only meets once in 2^32 numbers
+  check(MTRand_open::to_float(0xFFFFFFFFU) < 1.f, "largest word below 1");
+  check(MTRand_open::to_float(0U) > 0.f, "smallest word above 0");
+
+// fill() converts like to_float(), across state vector boundaries
+  const int block = 1000; // not a divisor of the 624 word state
+  MTRand_open filled(2024UL), single(2024UL);
+  float out[block];
+  float low = 1.f, high = 0.f;
+  bool same = true;
+  for (int b = 0; b < 20000; ++b) {
+    filled.fill(out, block);
+    for (int i = 0; i < block; ++i) {
+      if (out[i] != MTRand_open::to_float(single.rand_int32())) same = false;
+      if (out[i] < low) low = out[i];
+      if (out[i] > high) high = out[i];
+    }
+  }
+  check(same, "fill() equals to_float() of each word");
+  check(low > 0.f, "minimum output above 0");
+  check(high < 1.f, "maximum output below 1");
+
+  printf("min %.9g max %.9g, %d failures\n", low, high, failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+// streams_test.cpp
+// Checks the jump ahead behind RandomSource::seedStream(): substreams of
+// MT19937 and SFMT compose, MTRand_int32::split() hands over the parent's
+// stream, advance() of PCG32 and SplitMix64 equals stepping, and every
+// engine gives each (stream, substream) pair its own repeatable sequence.
+//
+//   g++ -O2 -I.. streams_test.cpp ../randomsource.cpp ../mtrand.cpp
+//       ../sfmtrand.cpp ../philox.cpp -o streams_test
+//
+// Returns 0 when every check passes.
+
+#include "randomsource.h"
+#include <stdio.h>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+  if (!ok) {
+    printf("FAILED: %s\n", what);
+    ++failures;
+  }
+}
+
+template <class A, class B>
+static bool sameWords(A& a, B& b, int count) {
+  for (int i = 0; i < count; ++i)
+    if (a.rand_int32() != b.rand_int32()) return false;
+  return true;
+}
+
+int main() {
+// substream(3) is substream(1) followed by substream(2)
+  MTRand_int32 mtA(2024UL), mtB(2024UL);
+  mtA.substream(3);
+  mtB.substream(1);
+  mtB.substream(2);
+  check(sameWords(mtA, mtB, 1000), "MT19937 substreams compose");
+
+  SFMTRand sfmtA(2024UL), sfmtB(2024UL);
+  sfmtA.substream(5);
+  sfmtB.substream(4);
+  sfmtB.substream(1);
+  check(sameWords(sfmtA, sfmtB, 1000), "SFMT substreams compose");
+
+// split(): the child continues the parent, the parent moves one substream on
+  MTRand_int32 parent(7UL), child(1UL), original(7UL), skipped(7UL);
+  for (int i = 0; i < 100; ++i) { parent.rand_int32(); original.rand_int32(); skipped.rand_int32(); }
+  parent.split(child);
+  skipped.substream(1);
+  check(sameWords(child, original, 1000), "split() child takes the parent's stream");
+  check(sameWords(parent, skipped, 1000), "split() parent skips a substream");
+
+  const uint64_t distances[] = { 0, 1, 2, 5, 1000, 65537 };
+  for (size_t d = 0; d < sizeof(distances) / sizeof(distances[0]); ++d) {
+    Pcg32 pcgA(9UL), pcgB(9UL);
+    SplitMix64 smA(9UL), smB(9UL);
+    pcgA.advance(distances[d]);
+    smA.advance(distances[d]);
+    for (uint64_t i = 0; i < distances[d]; ++i) { pcgB.rand_int32(); smB.rand_int32(); }
+    check(sameWords(pcgA, pcgB, 100), "PCG32 advance() equals stepping");
+    check(sameWords(smA, smB, 100), "SplitMix64 advance() equals stepping");
+  }
+
+// per engine: the same pair repeats, other pairs differ from the start
+  const uint64_t first = RandomSource::newStream();
+  check(RandomSource::newStream() != first, "newStream() numbers differ");
+  for (int engine = 0; engine < NUM_ENGINES; ++engine) {
+    const int pairs = 4;
+    const uint64_t streams[pairs] = { first, first, first + 1, first + 1 };
+    const int subs[pairs] = { 0, 1, 0, RANDOM_SUBSTREAMS - 1 };
+    uint32_t head[pairs][4];
+    for (int k = 0; k < pairs; ++k) {
+      RandomSource source, again;
+      source.setEngine(engine);
+      again.setEngine(engine);
+      source.seedStream(streams[k], subs[k]);
+      again.seedStream(streams[k], subs[k]);
+      check(sameWords(source, again, 100), "seedStream() repeats");
+      for (int i = 0; i < 4; ++i) head[k][i] = source.rand_int32();
+    }
+    for (int k = 0; k < pairs; ++k)
+      for (int j = k + 1; j < pairs; ++j) {
+        bool same = true;
+        for (int i = 0; i < 4; ++i) same = same && head[k][i] == head[j][i];
+        check(!same, "seedStream() pairs differ");
+      }
+  }
+
+  printf("%d failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}